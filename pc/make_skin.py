@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Convert an image into a Wio Terminal dashboard skin, and optionally upload it.
+
+Usage:
+  python pc/make_skin.py background.png skin.rle            # write the file only
+  python pc/make_skin.py background.png --port COM5         # convert and upload over USB serial
+
+The image should be 320x240 (it is resized if not). The firmware draws its bars,
+values, sparklines and status strip on top, so keep the bar slots dark grey and the
+value/status areas black; the header, labels and everything else are free.
+Send "?skin reset" on the serial console to go back to the built-in background.
+
+Needs Pillow, and pyserial for --port.
+"""
+import argparse
+import struct
+import sys
+
+try:
+    from PIL import Image
+except Exception as e:
+    print("Pillow is not installed or failed to import:", e)
+    raise
+
+WIDTH, HEIGHT = 320, 240
+MAGIC = b"WSK1"
+LAYOUT_CUSTOM = 0
+
+
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def encode_skin(img):
+    """RLE image as the firmware stores it: header, then [count u16 LE][RGB565 BE] runs."""
+    img = img.convert("RGB")
+    if img.size != (WIDTH, HEIGHT):
+        img = img.resize((WIDTH, HEIGHT))
+    out = bytearray(MAGIC + struct.pack("<HHHH", WIDTH, HEIGHT, LAYOUT_CUSTOM, 0))
+    run_color, run_len = None, 0
+    for r, g, b in img.getdata():
+        c = rgb565(r, g, b)
+        if c == run_color and run_len < 0xFFFF:
+            run_len += 1
+            continue
+        if run_len:
+            out += struct.pack("<H", run_len) + struct.pack(">H", run_color)
+        run_color, run_len = c, 1
+    out += struct.pack("<H", run_len) + struct.pack(">H", run_color)
+    return bytes(out)
+
+
+def upload(port, data, baud=115200):
+    try:
+        import serial
+    except Exception as e:
+        print("pyserial is not installed or failed to import:", e)
+        raise
+    with serial.Serial(port, baud, timeout=5) as ser:
+        ser.reset_input_buffer()
+        ser.write(f"?skin put {len(data)}\n".encode())
+        # Wait for the go-ahead; other '#' lines may be in the way
+        while True:
+            line = ser.readline().decode(errors="replace").strip()
+            if not line:
+                print("No answer from the device")
+                return False
+            if line.startswith("# skin:"):
+                break
+        if not line.startswith("# skin: send"):
+            print(line)
+            return False
+        for i in range(0, len(data), 1024):
+            ser.write(data[i:i + 1024])
+        while True:
+            line = ser.readline().decode(errors="replace").strip()
+            if not line:
+                print("No answer from the device")
+                return False
+            if line.startswith("# skin:"):
+                print(line)
+                return line == "# skin: loaded"
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Build (and upload) a Wio Terminal dashboard skin")
+    ap.add_argument("image", help="background image, ideally 320x240")
+    ap.add_argument("output", nargs="?", help="where to write the .rle file")
+    ap.add_argument("--port", help="serial port of the Wio Terminal to upload to")
+    ap.add_argument("--baud", type=int, default=115200)
+    args = ap.parse_args()
+
+    data = encode_skin(Image.open(args.image))
+    print(f"{len(data)} bytes ({(len(data) - 12) // 4} runs)")
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(data)
+    if args.port and not upload(args.port, data, args.baud):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -10,6 +10,7 @@ import psutil
 import requests
 import re
 import asyncio
+import struct
 try:
     from bleak import BleakClient
     BLEAK_AVAILABLE = True
@@ -24,7 +25,8 @@ SEND_INTERVAL_SEC = 0.5
 
 Changes:
 - Optional file logging (--log-file)
-- Uses LibreHardwareMonitor RemoteWebServer JSON or NVML for GPU
+- NVML/psutil first; LibreHardwareMonitor RemoteWebServer JSON only for what they lack
+- LHM sensor paths resolved once and re-read over a keep-alive session (--lhm-interval)
 - Initialize NVML once and reuse handle instead of per-iteration init
 """
 
@@ -42,43 +44,10 @@ NVML_HANDLE = None
 
 # --- LibreHardwareMonitor Remote Web Server JSON API ---
 LHM_REMOTE_URL = "http://localhost:8085/data.json"  # Change port if needed
-
-def fetch_lhm_json():
-    try:
-        resp = requests.get(LHM_REMOTE_URL, timeout=2)
-        if resp.status_code == 200:
-            data = resp.json()
-            try:
-                # Print a short summary for debugging
-                top_children = data.get('Children', [])
-                print(f"[debug] LHM JSON fetched: {len(top_children)} top children")
-                for entry in top_children:
-                    txt = entry.get('Text') or entry.get('Name') or ''
-                    print(f"  - section: {txt}")
-                # Also search for key sensor ids and print matches
-                def _search(node, path):
-                    if isinstance(node, dict):
-                        if 'id' in node and node.get('id') in (20, 221, 224):
-                            print(f"[debug] MATCH id={node.get('id')} path={'/'.join(path)} Value={node.get('Value')}")
-                        for k, v in node.items():
-                            if isinstance(v, (dict, list)):
-                                _search(v, path + [str(node.get('Text') or node.get('Name') or k)])
-                    elif isinstance(node, list):
-                        for i, item in enumerate(node):
-                            _search(item, path + [f'[{i}]'])
-                try:
-                    _search(data, ['root'])
-                except Exception:
-                    pass
-            except Exception:
-                pass
-            return data
-    except Exception:
-        pass
-    return None
+LHM_INTERVAL_SEC = 1.0  # LHM refreshes its sensors about once a second anyway
 
 
-# --- Helpers to index and parse sensors ---
+# --- Helpers to parse sensors ---
 _UNIT_RE = re.compile(r'([-+]?[0-9]*\.?[0-9]+)')
 
 def _parse_numeric(val: Any) -> float:
@@ -96,97 +65,110 @@ def _parse_numeric(val: Any) -> float:
     return -1.0
 
 
-def build_sensor_index(tree: Any, out: Dict[int, Dict] | None = None) -> Dict[int, Dict]:
-    if out is None:
-        out = {}
-    if isinstance(tree, dict):
-        sid = tree.get('id')
-        if isinstance(sid, int):
-            out[sid] = tree
-        for v in tree.values():
-            if isinstance(v, (dict, list)):
-                build_sensor_index(v, out)
-    elif isinstance(tree, list):
-        for item in tree:
-            if isinstance(item, (dict, list)):
-                build_sensor_index(item, out)
-    return out
-
-
-def build_sensorid_index(tree: Any, out: Dict[str, Dict] | None = None) -> Dict[str, Dict]:
-    """Build an index of sensors keyed by their string `SensorId` (if present).
-
-    This walks the deeply nested LHM JSON tree and returns a mapping from
-    SensorId (string) to the sensor dict so callers can lookup by the
-    SensorId path like '/gpu-nvidia/0/temperature/0'.
+class LhmReader:
+    """Reads a few sensors from the LibreHardwareMonitor JSON.
+
+    Each target is found once by walking the tree, and remembered as its path of
+    `Children` indexes; later fetches follow that path straight to the node and
+    only walk again if it no longer holds the same sensor (hardware or LHM
+    restarts). The HTTP connection is kept alive, values are cached for
+    `min_interval` seconds, and an unreachable server is retried every
+    RETRY_SEC instead of on every sample.
     """
-    if out is None:
+
+    # name -> (SensorId path, legacy numeric id)
+    TARGETS = {
+        'cpu_temp': ("/lpc/nct6701d/0/temperature/0", 20),
+        'gpu_temp': ("/gpu-nvidia/0/temperature/0", 221),
+        'gpu_load': ("/gpu-nvidia/0/load/0", 224),
+    }
+    RETRY_SEC = 30.0
+
+    def __init__(self, url: str, min_interval: float = LHM_INTERVAL_SEC) -> None:
+        self.url = url
+        self.min_interval = min_interval
+        self.session = requests.Session()
+        self.paths: Dict[str, Tuple[int, ...]] = {}
+        self.values: Dict[str, float] = {}
+        self.fetched_at = -1e9
+        self.retry_at = 0.0
+
+    def read(self) -> Dict[str, float]:
+        """Latest values by target name; missing ones are -1."""
+        now = time.monotonic()
+        if now - self.fetched_at >= self.min_interval and now >= self.retry_at:
+            self.fetched_at = now
+            data = self._fetch()
+            if data is None:
+                self.values = {}
+                self.retry_at = now + self.RETRY_SEC
+            else:
+                self.values = self._lookup(data)
+        return {name: self.values.get(name, -1.0) for name in self.TARGETS}
+
+    def _fetch(self) -> Optional[Dict]:
+        try:
+            resp = self.session.get(self.url, timeout=2)
+            if resp.status_code == 200:
+                return resp.json()
+        except Exception:
+            pass
+        return None
+
+    @staticmethod
+    def _matches(node: Any, sid: str, nid: int) -> bool:
+        return isinstance(node, dict) and (node.get('SensorId') == sid or
+                                           ('SensorId' not in node and node.get('id') == nid))
+
+    @staticmethod
+    def _follow(tree: Dict, path: Tuple[int, ...]) -> Any:
+        node: Any = tree
+        try:
+            for i in path:
+                node = node['Children'][i]
+        except (KeyError, IndexError, TypeError):
+            return None
+        return node
+
+    def _resolve(self, tree: Dict, wanted: list) -> None:
+        """One walk of the tree for every target in `wanted` (SensorId first, then numeric id)."""
+        by_sid, by_id = {}, {}
+        stack: list = [(tree, ())]
+        while stack:
+            node, path = stack.pop()
+            sid = node.get('SensorId')
+            if isinstance(sid, str):
+                by_sid.setdefault(sid, path)
+            elif isinstance(node.get('id'), int):
+                by_id.setdefault(node['id'], path)
+            for i, child in enumerate(node.get('Children') or ()):
+                if isinstance(child, dict):
+                    stack.append((child, path + (i,)))
+        for name in wanted:
+            sid, nid = self.TARGETS[name]
+            path = by_sid.get(sid, by_id.get(nid))
+            if path is not None:
+                self.paths[name] = path
+
+    def _lookup(self, tree: Dict) -> Dict[str, float]:
+        stale = [name for name, (sid, nid) in self.TARGETS.items()
+                 if not self._matches(self._follow(tree, self.paths.get(name, ())), sid, nid)]
+        if stale:
+            for name in stale:
+                self.paths.pop(name, None)
+            self._resolve(tree, stale)
         out = {}
-    if isinstance(tree, dict):
-        sid = tree.get('SensorId')
-        if isinstance(sid, str):
-            out[sid] = tree
-        for v in tree.values():
-            if isinstance(v, (dict, list)):
-                build_sensorid_index(v, out)
-    elif isinstance(tree, list):
-        for item in tree:
-            if isinstance(item, (dict, list)):
-                build_sensorid_index(item, out)
-    return out
-
-def get_cpu_temp_c_lhm_json(data):
-    """Get CPU temp from LHM JSON, or -1 if not found."""
-    try:
-        # Prefer lookup by SensorId (deeply nested path), fall back to numeric id
-        sid_idx = build_sensorid_index(data)
-        cpu_sid = "/lpc/nct6701d/0/temperature/0"
-        sensor = sid_idx.get(cpu_sid)
-        if sensor is not None:
-            val = sensor.get('Value', '')
-            print(f"[debug] CPU sensor SensorId={cpu_sid} raw Value={val}")
-            return _parse_numeric(val)
-        # Fallback to legacy numeric id-based lookup
-        idx = build_sensor_index(data)
-        sensor = idx.get(20)
-        if sensor is None:
-            return -1.0
-        val = sensor.get('Value', '')
-        print(f"[debug] CPU sensor id=20 raw Value={val}")
-        return _parse_numeric(val)
-    except Exception:
-        return -1.0
+        for name, path in self.paths.items():
+            node = self._follow(tree, path)
+            if isinstance(node, dict):
+                out[name] = _parse_numeric(node.get('Value'))
+        return out
 
-def get_gpu_metrics_lhm_json(data):
-    """Get (GPU usage %, GPU temp C) from LHM JSON, or (-1, -1) if not found."""
-    try:
-        # Prefer lookup by SensorId; these paths are used by LHM for GPU sensors
-        sid_idx = build_sensorid_index(data)
-        gpu_temp_sid = "/gpu-nvidia/0/temperature/0"
-        gpu_load_sid = "/gpu-nvidia/0/load/0"
-        # Look up temp
-        gtemp_sensor = sid_idx.get(gpu_temp_sid)
-        if gtemp_sensor is not None:
-            gpu_temp = _parse_numeric(gtemp_sensor.get('Value'))
-        else:
-            gpu_temp = -1.0
-        # Look up load
-        gload_sensor = sid_idx.get(gpu_load_sid)
-        if gload_sensor is not None:
-            gpu_load = _parse_numeric(gload_sensor.get('Value'))
-        else:
-            gpu_load = -1.0
-        if gtemp_sensor is not None or gload_sensor is not None:
-            print(f"[debug] GPU sensors SensorId temp={gtemp_sensor.get('Value') if gtemp_sensor else None} load={gload_sensor.get('Value') if gload_sensor else None}")
-            return gpu_load, gpu_temp
-        # Fallback to numeric ids used previously
-        idx = build_sensor_index(data)
-        gpu_temp = _parse_numeric(idx.get(221, {}).get('Value'))
-        gpu_load = _parse_numeric(idx.get(224, {}).get('Value'))
-        print(f"[debug] GPU sensors raw temp={idx.get(221, {}).get('Value')} load={idx.get(224, {}).get('Value')}")
-        return gpu_load, gpu_temp
-    except Exception:
-        return -1.0, -1.0
+
+LHM = LhmReader(LHM_REMOTE_URL)
+# "auto": NVML and psutil first, LHM only for what they cannot give (usually the CPU
+# temperature on Windows); "lhm": LHM first, as before; "native": never ask LHM
+SENSOR_SOURCE = "auto"
 
 
 def init_nvml_once() -> None:
@@ -230,27 +212,341 @@ def get_gpu_metrics_nvml() -> Tuple[float, float]:
 
 
 
+def get_cpu_temp_psutil() -> float:
+    """CPU package temperature from psutil where it has one (Linux, BSD); -1 otherwise."""
+    try:
+        temps = psutil.sensors_temperatures() if hasattr(psutil, 'sensors_temperatures') else {}
+    except Exception:
+        return -1.0
+    for chip in ('coretemp', 'k10temp', 'zenpower', 'cpu_thermal', 'acpitz'):
+        entries = temps.get(chip)
+        if entries:
+            return float(entries[0].current)
+    return -1.0
+
+
 # --- Metrics collection function ---
 def get_metrics() -> tuple[float, float, float, float, float]:
     cpu = float(psutil.cpu_percent(interval=None))
     ram = float(psutil.virtual_memory().percent)
-    lhm_data = fetch_lhm_json()
-    if lhm_data:
-        temp_c = get_cpu_temp_c_lhm_json(lhm_data)
-        gpu_usage, gpu_temp = get_gpu_metrics_lhm_json(lhm_data)
-        debug_src = 'LHM_JSON'
-    else:
-        temp_c = -1.0
-        gpu_usage, gpu_temp = get_gpu_metrics_nvml()
-        debug_src = 'NVML' if NVML_AVAILABLE else 'none'
-    # Debug print
-    #print(f"[debug] src={debug_src} cpu={cpu:.1f} temp={temp_c:.1f} ram={ram:.1f} gpu={gpu_usage:.1f} gputemp={gpu_temp:.1f}")
+    if SENSOR_SOURCE == "lhm":
+        lhm = LHM.read()
+        temp_c, gpu_usage, gpu_temp = lhm['cpu_temp'], lhm['gpu_load'], lhm['gpu_temp']
+        if gpu_usage < 0 and gpu_temp < 0:
+            gpu_usage, gpu_temp = get_gpu_metrics_nvml()
+        return cpu, temp_c, ram, gpu_usage, gpu_temp
+    gpu_usage, gpu_temp = get_gpu_metrics_nvml()
+    temp_c = get_cpu_temp_psutil()
+    if SENSOR_SOURCE == "auto" and (temp_c < 0 or gpu_usage < 0 or gpu_temp < 0):
+        # Only for what the native path could not give
+        lhm = LHM.read()
+        temp_c = temp_c if temp_c >= 0 else lhm['cpu_temp']
+        gpu_usage = gpu_usage if gpu_usage >= 0 else lhm['gpu_load']
+        gpu_temp = gpu_temp if gpu_temp >= 0 else lhm['gpu_temp']
     return cpu, temp_c, ram, gpu_usage, gpu_temp
 
 
 # serial port functions removed — BLE-only operation
 
 
+# --- Binary framed protocol (see wio-terminal/src/protocol.h) ---
+FRAME_SYNC = 0xA5
+FRAME_VERSION = 1
+FRAME_SAMPLE = 0x01
+FRAME_SCHEMA = 0x02
+FRAME_VALUES = 0x03
+FRAME_HOST = 0x04
+FRAME_BATCH = 0x05
+FRAME_STAMP = 0x06
+BATCH_MAX_PAYLOAD = 240  # FRAME_MAX_PAYLOAD in the firmware
+FRAME_CAPS = 0x10
+FRAME_RATE = 0x11
+RATE_PAUSE = 1
+RATE_REASONS = {0x01: "screen off", 0x02: "render backlog", 0x04: "link errors"}
+FRAME_ECHO = 0x12
+ECHO_SUPERSEDED, ECHO_OFFSCREEN, ECHO_UNTIMED = 0x01, 0x02, 0x04
+
+# Field IDs for the schema protocol (MetricField in wio-terminal/src/metrics.h)
+FIELD_CPU, FIELD_TEMP, FIELD_RAM, FIELD_GPU, FIELD_GPUTEMP = range(5)
+FIELD_CORE0 = 8
+FIELD_CORE_MAX = 32
+FIELD_GPU_LOAD0 = FIELD_CORE0 + FIELD_CORE_MAX
+FIELD_GPU_TEMP0 = FIELD_GPU_LOAD0 + 4
+FIELD_FAN0 = FIELD_GPU_TEMP0 + 4
+FIELD_FAN_MAX = 8
+FIELD_NET_RX = FIELD_FAN0 + FIELD_FAN_MAX
+FIELD_NET_TX = FIELD_NET_RX + 1
+FIELD_DISK_READ = FIELD_NET_RX + 2
+FIELD_DISK_WRITE = FIELD_NET_RX + 3
+
+
+def crc8(data: bytes) -> int:
+    """CRC-8/ATM (poly 0x07, init 0x00), matching crc8Update() in the firmware."""
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def encode_frame(frame_type: int, payload: bytes) -> bytes:
+    body = bytes((FRAME_VERSION, frame_type, len(payload))) + payload
+    return bytes((FRAME_SYNC,)) + body + bytes((crc8(body),))
+
+
+def encode_sample_frame(values: Tuple[float, ...]) -> bytes:
+    """Pack (cpu, temp, ram, gpu, gputemp) as int16 tenths with all fields present."""
+    mask = 0
+    packed = b''
+    for i, v in enumerate(values):
+        mask |= 1 << i
+        packed += struct.pack('<h', max(-32768, min(32767, int(round(v * 10)))))
+    return encode_frame(FRAME_SAMPLE, bytes((mask,)) + packed)
+
+
+def batch_capacity(max_frame: int, fields: int = 5) -> int:
+    """How many full samples one FRAME_BATCH of at most max_frame bytes can carry."""
+    record = 2 + 2 * fields
+    payload = min(BATCH_MAX_PAYLOAD, max_frame - 5)
+    return max(0, (payload - 6) // record)
+
+
+def encode_batch_frame(samples: list) -> bytes:
+    """FRAME_BATCH from [(host ms, (cpu, temp, ram, gpu, gputemp)), ...], oldest first."""
+    t0 = samples[0][0]
+    payload = bytes((len(samples), (1 << len(samples[0][1])) - 1)) + struct.pack('<I', t0 & 0xFFFFFFFF)
+    for t, values in samples:
+        payload += struct.pack('<H', min(0xFFFF, max(0, t - t0)))
+        payload += b''.join(struct.pack('<h', _tenths(v)) for v in values)
+    return encode_frame(FRAME_BATCH, payload)
+
+
+def decode_frame(data: bytes) -> Optional[Tuple[int, bytes]]:
+    """Return (type, payload) for one complete, CRC-valid frame, else None."""
+    if len(data) < 5 or data[0] != FRAME_SYNC or data[1] != FRAME_VERSION:
+        return None
+    n = data[3]
+    if len(data) < 5 + n or crc8(data[1:4 + n]) != data[4 + n]:
+        return None
+    return data[2], bytes(data[4:4 + n])
+
+
+def _tenths(v: float) -> int:
+    return max(-32768, min(32767, int(round(v * 10))))
+
+
+def encode_host_frame(host_id: int, name: str = "") -> bytes:
+    """FRAME_HOST: tags a BLE write as coming from host_id, optionally naming it (<= 11 bytes)."""
+    return encode_frame(FRAME_HOST, bytes((host_id,)) + name.encode('utf-8')[:11])
+
+
+def encode_stamp_frame(seq: int, host_ms: int) -> bytes:
+    """FRAME_STAMP: the device echoes when the next sample was parsed and drawn."""
+    return encode_frame(FRAME_STAMP, struct.pack('<HI', seq & 0xFFFF, host_ms & 0xFFFFFFFF))
+
+
+def host_ms() -> int:
+    """The sender's clock in ms; FRAME_STAMP and FRAME_BATCH carry it modulo 2**32."""
+    return int(time.monotonic() * 1000)
+
+
+def encode_schema_frames(schema_id: int, ids: list, max_frame: int) -> list:
+    """Split a field-ID table into FRAME_SCHEMA chunks of at most max_frame bytes."""
+    per = max(1, max_frame - 5 - 3)
+    frames = []
+    for start in range(0, len(ids), per):
+        chunk = ids[start:start + per]
+        frames.append(encode_frame(FRAME_SCHEMA, bytes((schema_id, len(ids), start)) + bytes(chunk)))
+    return frames
+
+
+def encode_values_frames(schema_id: int, values: list, max_frame: int) -> list:
+    """Split int16 values (already scaled, schema order) into FRAME_VALUES chunks."""
+    per = max(1, (max_frame - 5 - 2) // 2)
+    frames = []
+    for start in range(0, len(values), per):
+        chunk = values[start:start + per]
+        packed = b''.join(struct.pack('<h', max(-32768, min(32767, v))) for v in chunk)
+        frames.append(encode_frame(FRAME_VALUES, bytes((schema_id, start)) + packed))
+    return frames
+
+
+class Pacing:
+    """Send pacing requested by the device through FRAME_RATE notifications.
+
+    A pause only holds while the device keeps repeating it, so a device that
+    rebooted or went out of range cannot leave the sender stopped for good.
+    """
+
+    PAUSE_STALE_SEC = 30.0
+
+    def __init__(self) -> None:
+        self.paused = False
+        self.floor_sec = 0.0
+        self.updated = 0.0
+
+    def on_frame(self, frame_type: int, payload: bytes) -> None:
+        if frame_type != FRAME_RATE or len(payload) < 4:
+            return
+        state, interval_ms, reasons = struct.unpack('<BHB', payload[:4])
+        paused, floor_sec = state == RATE_PAUSE, interval_ms / 1000.0
+        if (paused, floor_sec) != (self.paused, self.floor_sec):
+            why = ", ".join(n for bit, n in RATE_REASONS.items() if reasons & bit) or "clear"
+            what = "pause" if paused else (f"interval >= {floor_sec:.2f}s" if floor_sec else "normal rate")
+            log_print(f"[info] Device asks for {what} ({why})")
+        self.paused, self.floor_sec, self.updated = paused, floor_sec, time.monotonic()
+
+    def holding(self) -> bool:
+        return self.paused and time.monotonic() - self.updated < self.PAUSE_STALE_SEC
+
+    def interval(self, requested: float) -> float:
+        return max(requested, self.floor_sec)
+
+
+def _distribution(values: list) -> str:
+    if not values:
+        return "-"
+    v = sorted(values)
+    pick = lambda q: v[min(len(v) - 1, int(q * len(v)))]
+    return f"p50 {pick(0.5):.0f} / p90 {pick(0.9):.0f} / p99 {pick(0.99):.0f} / max {v[-1]:.0f} ms"
+
+
+class LatencyStats:
+    """Host -> device -> display latency from the device's FRAME_ECHO answers.
+
+    Each stamp carries the sender's clock and comes back with the device's own
+    parse->drawn and parse->echo times, so no clock sync is needed: the round trip
+    minus the device's part is time on the link, and half of it is taken as the way
+    there. Displayed latency is that plus parse->drawn.
+    """
+
+    ECHO_TIMEOUT_SEC = 5.0
+
+    def __init__(self, transport: str) -> None:
+        self.transport = transport
+        self.seq = 0
+        self.pending: Dict[int, float] = {}  # seq -> when it was sent (monotonic)
+        self._new_window()
+
+    def _new_window(self) -> None:
+        self.started = time.monotonic()
+        self.sent = 0
+        self.display: list = []
+        self.rtt: list = []
+        self.draw: list = []
+        self.superseded = self.offscreen = self.untimed = self.lost = 0
+
+    def stamp(self, sampled_ms: Optional[int] = None) -> bytes:
+        """FRAME_STAMP for the sample about to be written, taken at sampled_ms."""
+        self.seq = (self.seq + 1) & 0xFFFF
+        self.pending[self.seq] = time.monotonic()
+        self.sent += 1
+        return encode_stamp_frame(self.seq, host_ms() if sampled_ms is None else sampled_ms)
+
+    def on_frame(self, frame_type: int, payload: bytes) -> None:
+        if frame_type != FRAME_ECHO or len(payload) < 12:
+            return
+        seq, sent_ms, flags, lost, draw_ms, send_ms = struct.unpack('<HIBBHH', payload[:12])
+        if self.pending.pop(seq, None) is None:
+            return  # given up on already, or another sender's
+        for k in range(1, lost + 1):
+            if self.pending.pop((seq - k) & 0xFFFF, None) is not None:
+                self.lost += 1
+        rtt = (host_ms() - sent_ms) & 0xFFFFFFFF
+        self.rtt.append(rtt)
+        if flags & ECHO_SUPERSEDED:
+            self.superseded += 1
+        elif flags & ECHO_OFFSCREEN:
+            self.offscreen += 1
+        elif flags & ECHO_UNTIMED:
+            self.untimed += 1
+        else:
+            self.draw.append(draw_ms)
+            self.display.append(max(0, rtt - send_ms) / 2 + draw_ms)
+
+    def log_every(self, period_sec: float) -> None:
+        now = time.monotonic()
+        if now - self.started < period_sec:
+            return
+        expired = [seq for seq, at in self.pending.items() if now - at > self.ECHO_TIMEOUT_SEC]
+        for seq in expired:
+            del self.pending[seq]
+        log_print(f"[latency] {self.transport}: {self.sent} stamped, {len(self.display)} drawn; "
+                  f"to display {_distribution(self.display)}; round trip {_distribution(self.rtt)}; "
+                  f"device parse->drawn {_distribution(self.draw)}")
+        log_print(f"[latency] {self.transport}: lost {self.lost} before the device, {len(expired)} unanswered, "
+                  f"{self.superseded} replaced before drawn, {self.offscreen} not on screen, "
+                  f"{self.untimed} unmeasured")
+        self._new_window()
+
+
+class ExtendedMetrics:
+    """Collects per-core load, extra GPUs, fans, network and disk throughput as
+    (field_id, int16 value) pairs. Rates are computed from counter deltas."""
+
+    def __init__(self) -> None:
+        self._last_net = None
+        self._last_disk = None
+        self._last_t = None
+
+    def collect(self, legacy: Tuple[float, ...]) -> list:
+        out = [(FIELD_CPU + i, _tenths(v)) for i, v in enumerate(legacy)]
+        try:
+            for i, load in enumerate(psutil.cpu_percent(interval=None, percpu=True)[:FIELD_CORE_MAX]):
+                out.append((FIELD_CORE0 + i, _tenths(load)))
+        except Exception:
+            pass
+        out.extend(self._extra_gpus())
+        try:
+            fans = psutil.sensors_fans() if hasattr(psutil, 'sensors_fans') else {}
+            rpms = [f.current for entries in fans.values() for f in entries][:FIELD_FAN_MAX]
+            for i, rpm in enumerate(rpms):
+                out.append((FIELD_FAN0 + i, int(rpm)))  # whole RPM, not tenths
+        except Exception:
+            pass
+        out.extend(self._rates())
+        return out
+
+    @staticmethod
+    def _extra_gpus() -> list:
+        out = []
+        if not NVML_AVAILABLE:
+            return out
+        init_nvml_once()
+        if not NVML_INIT:
+            return out
+        try:
+            for i in range(1, min(pynvml.nvmlDeviceGetCount(), 5)):
+                h = pynvml.nvmlDeviceGetHandleByIndex(i)
+                out.append((FIELD_GPU_LOAD0 + i - 1, _tenths(pynvml.nvmlDeviceGetUtilizationRates(h).gpu)))
+                out.append((FIELD_GPU_TEMP0 + i - 1,
+                            _tenths(pynvml.nvmlDeviceGetTemperature(h, pynvml.NVML_TEMPERATURE_GPU))))
+        except Exception:
+            pass
+        return out
+
+    def _rates(self) -> list:
+        now = time.monotonic()
+        try:
+            net = psutil.net_io_counters()
+            disk = psutil.disk_io_counters()
+        except Exception:
+            return []
+        out = []
+        if self._last_t is not None and now > self._last_t:
+            dt = now - self._last_t
+            mbps = lambda a, b: _tenths((a - b) / dt / 1e6)
+            if net and self._last_net:
+                out.append((FIELD_NET_RX, mbps(net.bytes_recv, self._last_net.bytes_recv)))
+                out.append((FIELD_NET_TX, mbps(net.bytes_sent, self._last_net.bytes_sent)))
+            if disk and self._last_disk:
+                out.append((FIELD_DISK_READ, mbps(disk.read_bytes, self._last_disk.read_bytes)))
+                out.append((FIELD_DISK_WRITE, mbps(disk.write_bytes, self._last_disk.write_bytes)))
+        self._last_net, self._last_disk, self._last_t = net, disk, now
+        return out
+
+
 LOG_FILE = None  # type: Optional[str]
 
 
@@ -276,12 +572,38 @@ def main() -> int:
     parser.add_argument("--verbose", action="store_true", help="Print each line sent")
     parser.add_argument("--ble-address", help="BLE peripheral address to connect to (e.g., AA:BB:CC:DD:EE:FF)")
     parser.add_argument("--log-file", help="Append logs to this file (optional)")
+    parser.add_argument("--format", choices=("csv", "binary", "schema"), default="csv",
+                        help="Wire format: CSV text line, compact binary frame, or schema-negotiated "
+                             "frames with per-core/fan/net/disk fields (default csv)")
+    parser.add_argument("--batch", type=int, default=1, metavar="N",
+                        help="With --format binary, send up to N samples per BLE write (as many as fit the MTU); "
+                             "each is still polled every --interval (default 1: one sample per write)")
+    parser.add_argument("--sensors", choices=("auto", "native", "lhm"), default="auto",
+                        help="Sensor source: NVML/psutil with LibreHardwareMonitor only for what they lack (auto), "
+                             "NVML/psutil only (native), or LibreHardwareMonitor first as before (lhm)")
+    parser.add_argument("--lhm-interval", type=float, default=LHM_INTERVAL_SEC, metavar="SEC",
+                        help="Poll LibreHardwareMonitor at most this often; samples in between reuse its last "
+                             f"values (default {LHM_INTERVAL_SEC}s)")
+    parser.add_argument("--lhm-url", default=LHM_REMOTE_URL, help=f"LibreHardwareMonitor JSON URL (default {LHM_REMOTE_URL})")
+    parser.add_argument("--latency", action="store_true",
+                        help="Stamp every sample and log host->display latency and lost samples from the "
+                             "device's echoes (firmware without it ignores the stamps)")
+    parser.add_argument("--latency-log-sec", type=float, default=10.0, metavar="SEC",
+                        help="Log the latency distribution this often (default 10s)")
+    parser.add_argument("--host-id", type=int, choices=range(1, 256), metavar="1-255",
+                        help="Tag every BLE write with this host ID so one Wio Terminal can show several PCs")
+    parser.add_argument("--host-name", default=platform.node(),
+                        help="Name shown for this PC when --host-id is set (default: hostname)")
     args = parser.parse_args()
 
-    global LOG_FILE
+    global LOG_FILE, LHM, SENSOR_SOURCE
     LOG_FILE = args.log_file or None
+    SENSOR_SOURCE = args.sensors
+    LHM = LhmReader(args.lhm_url, max(0.0, args.lhm_interval))
 
     BLE_UART_RX_UUID = "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"
+    BLE_UART_TX_UUID = "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"
+    SCHEMA_RESEND_SEC = 30.0
 
     if not BLEAK_AVAILABLE:
         log_print("[error] bleak not installed; --ble-address cannot be used. Install with pip install bleak")
@@ -358,15 +680,112 @@ def main() -> int:
                 return 5
             log_print(f"[info] Connected to BLE {ble_address}")
 
+            # Schema mode state: the device's advertised capacity and the table last sent
+            extended = ExtendedMetrics()
+            max_fields = 64
+            schema_ids: list = []
+            schema_id = 0
+            schema_sent_at = 0.0
+
+            async def read_caps(client: BleakClient) -> None:
+                nonlocal max_fields
+                try:
+                    frame = decode_frame(bytes(await client.read_gatt_char(BLE_UART_TX_UUID)))
+                    if frame and frame[0] == FRAME_CAPS and len(frame[1]) >= 2:
+                        max_fields = frame[1][1]
+                        log_print(f"[info] Device capacity: {max_fields} fields")
+                except Exception as e:
+                    log_print(f"[debug] Could not read device capacity: {e}")
+
+            pacing = Pacing()
+            latency = LatencyStats("BLE") if args.latency else None
+
+            def on_notify(_sender: Any, data: bytearray) -> None:
+                frame = decode_frame(bytes(data))
+                if frame:
+                    pacing.on_frame(*frame)
+                    if latency:
+                        latency.on_frame(*frame)
+
+            async def subscribe(client: BleakClient) -> None:
+                try:
+                    await client.start_notify(BLE_UART_TX_UUID, on_notify)
+                except Exception as e:
+                    log_print(f"[debug] Could not subscribe to device notifications: {e}")
+
+            def max_frame_len(client: BleakClient) -> int:
+                try:
+                    return max(20, int(client.mtu_size) - 3)
+                except Exception:
+                    return 20
+
+            # With --host-id every write starts with a short HOST frame; the named one is
+            # sent on its own now and then so the device can label this PC's page.
+            host_prefix = encode_host_frame(args.host_id) if args.host_id else b''
+            host_named_at = 0.0
+
+            async def ble_write(client: BleakClient, data: bytes, stamp: bytes = b'') -> None:
+                # A stamp that doesn't fit the MTU with its sample goes in a write of its own
+                if stamp and len(host_prefix) + len(stamp) + len(data) > max_frame_len(client):
+                    await client.write_gatt_char(BLE_UART_RX_UUID, host_prefix + stamp)
+                    stamp = b''
+                await client.write_gatt_char(BLE_UART_RX_UUID, host_prefix + stamp + data)
+
+            if args.format == "schema":
+                await read_caps(ble_client)
+            await subscribe(ble_client)
+            batch: list = []  # (host ms, values) waiting for a --batch write
+
             while True:
+                if pacing.holding():
+                    # Screen is off: skip sensor polling (LHM, NVML, psutil) and the radio
+                    batch.clear()
+                    await asyncio.sleep(0.5)
+                    continue
                 cpu, temp_c, ram, gpu_usage, gpu_temp = await asyncio.to_thread(get_metrics)
+                sampled_ms = host_ms()
                 line = f"{cpu:.1f},{temp_c:.1f},{ram:.1f},{gpu_usage:.1f},{gpu_temp:.1f}\n"
                 if args.dry_run:
                     log_print(line.strip())
                 else:
                     log_print(f"[send] CPU%={cpu:.1f} CPU_TEMP_C={temp_c:.1f} RAM%={ram:.1f} GPU%={gpu_usage:.1f} GPU_TEMP_C={gpu_temp:.1f}")
                     try:
-                        await ble_client.write_gatt_char(BLE_UART_RX_UUID, line.encode('utf-8'))
+                        if args.host_id and time.monotonic() - host_named_at > SCHEMA_RESEND_SEC:
+                            await ble_client.write_gatt_char(BLE_UART_RX_UUID,
+                                                             encode_host_frame(args.host_id, args.host_name))
+                            host_named_at = time.monotonic()
+                        if args.format == "schema":
+                            fields = extended.collect((cpu, temp_c, ram, gpu_usage, gpu_temp))[:max_fields]
+                            ids = [fid for fid, _ in fields]
+                            mtu_len = max_frame_len(ble_client) - len(host_prefix)
+                            now = time.monotonic()
+                            if ids != schema_ids or now - schema_sent_at > SCHEMA_RESEND_SEC:
+                                if ids != schema_ids:
+                                    schema_id = schema_id % 255 + 1
+                                    schema_ids = ids
+                                for frame in encode_schema_frames(schema_id, ids, mtu_len):
+                                    await ble_write(ble_client, frame)
+                                schema_sent_at = now
+                            values = encode_values_frames(schema_id, [v for _, v in fields], mtu_len)
+                            for i, frame in enumerate(values):
+                                # The stamp tags the sample the last chunk completes; it rides on the first
+                                await ble_write(ble_client, frame, latency.stamp(sampled_ms) if latency and i == 0 else b'')
+                            payload = None
+                        elif args.format == "binary" and args.batch > 1:
+                            batch.append((sampled_ms, (cpu, temp_c, ram, gpu_usage, gpu_temp)))
+                            fit = batch_capacity(max_frame_len(ble_client) - len(host_prefix))
+                            payload = None
+                            if len(batch) >= max(1, min(args.batch, fit)):
+                                payload = encode_batch_frame(batch) if fit > 0 else \
+                                    encode_sample_frame(batch[-1][1])
+                                sampled_ms = batch[-1][0]  # the newest record is the one drawn
+                                batch = []
+                        elif args.format == "binary":
+                            payload = encode_sample_frame((cpu, temp_c, ram, gpu_usage, gpu_temp))
+                        else:
+                            payload = line.encode('utf-8')
+                        if payload is not None:
+                            await ble_write(ble_client, payload, latency.stamp(sampled_ms) if latency else b'')
                         if args.verbose:
                             log_print(f"[ble] {line.strip()}")
                     except Exception as e:
@@ -379,7 +798,15 @@ def main() -> int:
                         ble_client = await connect_with_retries(ble_address)
                         if not ble_client:
                             log_print("[warn] BLE reconnect failed; will retry sending after backoff")
-                await asyncio.sleep(max(0.05, float(args.interval)))
+                        else:
+                            if args.format == "schema":
+                                await read_caps(ble_client)
+                                schema_sent_at = 0.0  # device may have rebooted: resend the table
+                            await subscribe(ble_client)
+                        host_named_at = 0.0
+                if latency:
+                    latency.log_every(max(1.0, args.latency_log_sec))
+                await asyncio.sleep(max(0.05, pacing.interval(float(args.interval))))
         except asyncio.CancelledError:
             log_print("\n[info] Stopped by user")
         finally:
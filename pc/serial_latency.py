@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Measure host -> display latency over USB serial, to compare with BLE.
+
+Usage:
+  python pc/serial_latency.py --port COM5                             # a sample every 0.5 s until Ctrl-C
+  python pc/serial_latency.py --port COM5 --interval 0.05 --seconds 60
+
+Sends this PC's metrics as stamped binary sample frames, as
+`pc_stats_sender.py --format binary --latency` does over BLE, and logs the same
+latency and loss summary from the echoes the device writes back on Serial.
+Needs pyserial and the sender's own dependencies.
+"""
+import argparse
+import sys
+import threading
+import time
+
+import pc_stats_sender as sender
+
+
+def pop_frames(buf: bytearray) -> list:
+    """Take the complete frames out of what the device wrote; its '#' lines are dropped."""
+    frames = []
+    while True:
+        start = buf.find(bytes((sender.FRAME_SYNC,)))
+        if start < 0:
+            buf.clear()
+            return frames
+        del buf[:start]
+        if len(buf) >= 2 and buf[1] != sender.FRAME_VERSION:
+            del buf[:1]  # a stray sync byte
+            continue
+        if len(buf) < 4 or len(buf) < 5 + buf[3]:
+            return frames  # rest of the frame still to come
+        n = 5 + buf[3]
+        frame = sender.decode_frame(bytes(buf[:n]))
+        if frame:
+            frames.append(frame)
+            del buf[:n]
+        else:
+            del buf[:1]  # not a frame after all: look for the next sync byte
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Measure Wio Terminal display latency over USB serial")
+    ap.add_argument("--port", required=True, help="serial port of the Wio Terminal")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--interval", type=float, default=sender.SEND_INTERVAL_SEC,
+                    help=f"send interval seconds (default {sender.SEND_INTERVAL_SEC}s)")
+    ap.add_argument("--seconds", type=float, default=0.0, help="stop after this long (default: until Ctrl-C)")
+    ap.add_argument("--log-sec", type=float, default=10.0, help="log the distribution this often (default 10s)")
+    args = ap.parse_args()
+
+    try:
+        import serial
+    except Exception as e:
+        print("pyserial is not installed or failed to import:", e)
+        raise
+
+    stats = sender.LatencyStats("USB")
+    lock = threading.Lock()
+    stop = threading.Event()
+
+    # Echoes are timed as they arrive, not when the send loop next looks
+    def reader(ser) -> None:
+        buf = bytearray()
+        while not stop.is_set():
+            data = ser.read(ser.in_waiting or 1)
+            if not data:
+                continue
+            buf += data
+            for frame in pop_frames(buf):
+                with lock:
+                    stats.on_frame(*frame)
+
+    with serial.Serial(args.port, args.baud, timeout=0.1) as ser:
+        ser.reset_input_buffer()
+        thread = threading.Thread(target=reader, args=(ser,), daemon=True)
+        thread.start()
+        end = time.monotonic() + args.seconds if args.seconds > 0 else None
+        try:
+            while end is None or time.monotonic() < end:
+                values = sender.get_metrics()
+                with lock:
+                    ser.write(stats.stamp() + sender.encode_sample_frame(values))
+                    stats.log_every(max(1.0, args.log_sec))
+                time.sleep(max(0.01, args.interval))
+            time.sleep(stats.ECHO_TIMEOUT_SEC)  # let the last echoes come in
+            with lock:
+                stats.log_every(0.0)
+        except KeyboardInterrupt:
+            pass
+        stop.set()
+        thread.join()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,178 @@
+// Host micro-benchmarks for the firmware core: parsers and dashboard diffing.
+// Build and run with:  pio run -e native && .pio/build/native/program
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <chrono>
+#include <new>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "protocol.h"
+#include "dashboard.h"
+#include "host_sources.h"
+
+HostSerial Serial;
+
+// Count heap allocations so "allocations per sample" is measured, not assumed
+static size_t allocations = 0;
+void *operator new(size_t n) {
+  allocations++;
+  void *p = malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+static double seconds(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Deterministic random walk resembling a PC under changing load (tenths)
+struct Trace {
+  uint32_t seed = 12345;
+  int16_t v[FIELD_LEGACY_COUNT] = { 300, 550, 600, 200, 650 };
+
+  uint32_t next() { seed = seed * 1664525u + 1013904223u; return seed >> 8; }
+  Metrics step() {
+    Metrics m;
+    for (uint8_t f = 0; f < FIELD_LEGACY_COUNT; ++f) {
+      int d = (int)(next() % 61) - 30; // +-3.0 per sample
+      int x = v[f] + d;
+      v[f] = (int16_t)(x < 0 ? 0 : (x > 1000 ? 1000 : x));
+      m.v[f] = v[f];
+    }
+    return m;
+  }
+};
+
+static const int SAMPLES = 200000;
+
+static void benchCsv() {
+  Trace t;
+  std::string wire;
+  char line[64];
+  for (int i = 0; i < SAMPLES; ++i) {
+    Metrics m = t.step();
+    char *p = line;
+    for (uint8_t f = 0; f < FIELD_LEGACY_COUNT; ++f) {
+      if (f) *p++ = ',';
+      p = formatTenths(p, m.v[f]);
+    }
+    *p++ = '\n';
+    wire.append(line, p);
+  }
+
+  LineParser parser;
+  Metrics out;
+  long ok = 0;
+  size_t a0 = allocations;
+  auto t0 = std::chrono::steady_clock::now();
+  for (char c : wire) {
+    if (parser.feed(c) == LineParser::LINE_OK) { parser.apply(out); ok++; }
+  }
+  double s = seconds(t0);
+  printf("csv      %8.0f lines/s  %6.1f MB/s  %.3f allocs/sample  (%ld lines)\n",
+         ok / s, wire.size() / s / 1e6, (double)(allocations - a0) / ok, ok);
+}
+
+static void benchFrames() {
+  Trace t;
+  std::vector<uint8_t> wire;
+  uint8_t frame[SAMPLE_FRAME_MAX];
+  for (int i = 0; i < SAMPLES; ++i) {
+    Metrics m = t.step();
+    size_t n = encodeSampleFrame(m, FIELD_MASK_ALL, frame, sizeof(frame));
+    wire.insert(wire.end(), frame, frame + n);
+  }
+
+  FrameDecoder dec;
+  Metrics out;
+  long ok = 0;
+  size_t a0 = allocations;
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint8_t b : wire) {
+    if (dec.feed(b) == FrameDecoder::FRAME_OK && decodeSampleFrame(dec.payload(), dec.length(), out)) ok++;
+  }
+  double s = seconds(t0);
+  printf("frames   %8.0f frames/s %6.1f MB/s  %.3f allocs/sample  (%ld frames)\n",
+         ok / s, wire.size() / s / 1e6, (double)(allocations - a0) / ok, ok);
+}
+
+// Serial routing check: frames whose value, length or CRC bytes are 0x3F ('?')
+// must reach the frame decoder, not start a command. Returns false on failure.
+static bool checkSerialRouting() {
+  std::vector<uint8_t> wire;
+  uint8_t frame[SAMPLE_FRAME_MAX];
+  int sent = 0;
+  for (int16_t v = 0; v < 1024; ++v) {
+    Metrics m;
+    for (uint8_t f = 0; f < FIELD_LEGACY_COUNT; ++f) m.v[f] = (int16_t)(v + f * 0x3F);
+    size_t n = encodeSampleFrame(m, FIELD_MASK_ALL, frame, sizeof(frame));
+    wire.insert(wire.end(), frame, frame + n);
+    sent++;
+  }
+  int withQuestion = 0;
+  for (uint8_t b : wire) withQuestion += b == '?';
+
+  RxStream rx;
+  int ok = 0, commands = 0;
+  for (uint8_t b : wire) {
+    switch (rx.route(b, true)) {
+      case RxStream::ROUTE_FRAME:
+        if (rx.frame.feed(b) == FrameDecoder::FRAME_OK) ok++;
+        break;
+      case RxStream::ROUTE_COMMAND:
+        commands++;
+        break;
+      default:
+        rx.line.feed((char)b);
+        break;
+    }
+  }
+  bool pass = ok == sent && commands == 0;
+  printf("routing  %s: %d/%d serial frames decoded, %d '?' bytes inside them, %d taken as commands\n",
+         pass ? "ok" : "FAIL", ok, sent, withQuestion, commands);
+  return pass;
+}
+
+static void benchRender() {
+  TFT_eSPI tft;
+  Dashboard dash(tft);
+  dash.begin();
+  dash.drawStatic();
+  dash.invalidate();
+
+  Trace t;
+  const int FRAMES = 20000;
+  uint64_t cmds = 0, px = 0, ram = 0, calls = 0;
+  uint32_t maxCmds = 0, maxPx = 0, idle = 0;
+  size_t a0 = allocations;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < FRAMES; ++i) {
+    tft.counters = TftCounters();
+    dash.update(t.step(), (uint32_t)i * (1000 / RENDER_MAX_FPS));
+    const TftCounters &c = tft.counters;
+    cmds += c.commands; px += c.pixels; ram += c.ramPixels; calls += c.calls;
+    if (c.commands > maxCmds) maxCmds = c.commands;
+    if (c.pixels > maxPx) maxPx = c.pixels;
+    if (c.commands == 0) idle++;
+  }
+  double s = seconds(t0);
+  printf("render   %8.0f frames/s (host)  %.3f allocs/frame  sprites=%d\n",
+         FRAMES / s, (double)(allocations - a0) / FRAMES, WIO_USE_SPRITES);
+  printf("         per frame: %.1f calls  %.1f SPI cmds (max %u)  %.0f px (max %u)  %.0f sprite px  %.1f%% frames with no output\n",
+         (double)calls / FRAMES, (double)cmds / FRAMES, maxCmds, (double)px / FRAMES, maxPx,
+         (double)ram / FRAMES, 100.0 * idle / FRAMES);
+}
+
+int main() {
+  if (!checkSerialRouting()) return 1;
+  benchCsv();
+  benchFrames();
+  benchRender();
+  return 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+// Just enough of the Arduino core for the firmware's hardware-independent
+// sources to build on the host (the `native` env in platformio.ini).
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+inline unsigned long millis() {
+  using namespace std::chrono;
+  static const steady_clock::time_point t0 = steady_clock::now();
+  return (unsigned long)duration_cast<milliseconds>(steady_clock::now() - t0).count();
+}
+
+inline unsigned long micros() {
+  using namespace std::chrono;
+  static const steady_clock::time_point t0 = steady_clock::now();
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now() - t0).count();
+}
+
+class Print {
+public:
+  size_t print(const char *s) { return fputs(s, stdout) >= 0 ? strlen(s) : 0; }
+  size_t println(const char *s) { size_t n = print(s); fputc('\n', stdout); return n + 1; }
+};
+
+class HostSerial : public Print {};
+extern HostSerial Serial;
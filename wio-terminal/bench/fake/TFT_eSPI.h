@@ -0,0 +1,120 @@
+#pragma once
+// Recording stand-in for TFT_eSPI on the host. Nothing is rasterised: every
+// panel call is logged and costed the way the ILI9341 driver would issue it,
+// so benchmarks can count SPI commands and pixels per frame.
+//
+// Cost model (per call that reaches the panel):
+//   address window  CASET + RASET + RAMWR = 3 commands
+//   fillRect        1 window + w*h pixels
+//   drawString/print  1 window + 6x8*size^2 pixels per glyph (opaque text), plus
+//                   a fillRect for any text padding left of the glyphs
+//   pushColors/pushBlock  pixels only (after setAddrWindow)
+//   drawChar        as one glyph of drawString
+//   pushImage       1 window + w*h pixels
+// Sprite calls only touch RAM and are tallied separately.
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#define TFT_BLACK    0x0000
+#define TFT_WHITE    0xFFFF
+#define TFT_DARKGREY 0x7BEF
+#define TFT_RED      0xF800
+#define TFT_GREEN    0x07E0
+#define TFT_CYAN     0x07FF
+#define TFT_YELLOW   0xFFE0
+#define TFT_ORANGE   0xFDA0
+
+#define TL_DATUM 0
+#define ML_DATUM 3
+#define MR_DATUM 5
+
+// One logged panel operation
+struct TftOp {
+  enum Kind : uint8_t { FILL, TEXT, WINDOW, PIXELS, LINE } kind;
+  int16_t x, y, w, h;
+  uint32_t pixels;
+};
+
+// Running totals; reset between frames to get per-frame figures
+struct TftCounters {
+  uint32_t calls = 0;        // API calls that reach the panel
+  uint32_t commands = 0;     // SPI command bytes (CASET/RASET/RAMWR...)
+  uint32_t pixels = 0;       // pixels clocked out
+  uint32_t transactions = 0; // startWrite/endWrite pairs
+  uint32_t ramPixels = 0;    // pixels written into sprites
+};
+
+class TFT_eSPI {
+public:
+  TFT_eSPI(int16_t w = 320, int16_t h = 240) : width_(w), height_(h) {}
+  virtual ~TFT_eSPI() {}
+
+  void init() {}
+  void setRotation(uint8_t) {}
+  void setSwapBytes(bool) {}
+
+  void setTextColor(uint16_t, uint16_t) {}
+  void setTextColor(uint16_t) {}
+  void setTextSize(uint8_t s) { textSize = s ? s : 1; }
+  void setTextDatum(uint8_t d) { datum = d; }
+  void setTextPadding(uint16_t p) { padding = p; }
+  void setCursor(int16_t x, int16_t y) { cx = x; cy = y; }
+
+  int16_t textWidth(const char *s) const { return (int16_t)(strlen(s) * 6 * textSize); }
+  int16_t fontHeight() const { return (int16_t)(8 * textSize); }
+
+  virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void fillScreen(uint32_t color) { fillRect(0, 0, width_, height_, color); }
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+  void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+
+  void print(const char *s);
+  void println(const char *s) { print(s); cx = 0; cy += fontHeight(); }
+  int16_t drawString(const char *s, int32_t x, int32_t y);
+  void drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size);
+  virtual void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+
+  void startWrite() { counters.transactions++; }
+  void endWrite() {}
+  void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h);
+  void pushColors(uint16_t *data, uint32_t len, bool swap = true);
+  void pushBlock(uint16_t color, uint32_t len);
+
+  TftCounters counters;
+  std::vector<TftOp> trace;   // every panel operation since the last clearTrace()
+  bool recordTrace = false;
+  void clearTrace() { trace.clear(); }
+
+protected:
+  virtual void glyphs(int32_t x, int32_t y, const char *s);
+  void log(TftOp::Kind k, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t px);
+
+  int16_t width_, height_;
+  uint8_t textSize = 1;
+  uint8_t datum = TL_DATUM;
+  uint16_t padding = 0;
+  int16_t cx = 0, cy = 0;
+};
+
+// RAM-backed sprite: keeps a real 16-bit buffer for fills so pushes carry data
+class TFT_eSprite : public TFT_eSPI {
+public:
+  explicit TFT_eSprite(TFT_eSPI *parent) : parent(parent) {}
+
+  void setColorDepth(int8_t) {}
+  void *createSprite(int16_t w, int16_t h);
+  void deleteSprite() { buf.clear(); }
+  void fillSprite(uint32_t color) { fillRect(0, 0, width_, height_, color); }
+  void *getPointer() { return buf.empty() ? nullptr : buf.data(); }
+
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) override;
+
+protected:
+  void glyphs(int32_t x, int32_t y, const char *s) override;
+
+private:
+  TFT_eSPI *parent;
+  std::vector<uint16_t> buf;
+};
@@ -0,0 +1,122 @@
+#include "TFT_eSPI.h"
+
+void TFT_eSPI::log(TftOp::Kind k, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t px) {
+  if (!recordTrace) return;
+  TftOp op = { k, (int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h, px };
+  trace.push_back(op);
+}
+
+void TFT_eSPI::setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) {
+  counters.commands += 3;
+  log(TftOp::WINDOW, x, y, w, h, 0);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t) {
+  if (w <= 0 || h <= 0) return;
+  counters.calls++;
+  counters.commands += 3;
+  counters.pixels += (uint32_t)(w * h);
+  log(TftOp::FILL, x, y, w, h, (uint32_t)(w * h));
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+  // Only axis-aligned lines are drawn by the firmware
+  if (y0 == y1) fillRect(x0 < x1 ? x0 : x1, y0, (x1 > x0 ? x1 - x0 : x0 - x1) + 1, 1, color);
+  else fillRect(x0, y0 < y1 ? y0 : y1, 1, (y1 > y0 ? y1 - y0 : y0 - y1) + 1, color);
+}
+
+void TFT_eSPI::fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color) {
+  // One horizontal span per row, as the driver does
+  for (int32_t dy = -r; dy <= r; ++dy) {
+    int32_t dx = 0;
+    while ((dx + 1) * (dx + 1) + dy * dy <= r * r) dx++;
+    fillRect(x - dx, y + dy, 2 * dx + 1, 1, color);
+  }
+}
+
+void TFT_eSPI::glyphs(int32_t x, int32_t y, const char *s) {
+  uint32_t gw = 6 * textSize, gh = 8 * textSize;
+  for (const char *p = s; *p; ++p) {
+    counters.calls++;
+    counters.commands += 3;
+    counters.pixels += gw * gh;
+    log(TftOp::TEXT, x + (int32_t)((p - s) * gw), y, (int32_t)gw, (int32_t)gh, gw * gh);
+  }
+}
+
+void TFT_eSPI::print(const char *s) {
+  glyphs(cx, cy, s);
+  cx += textWidth(s);
+}
+
+int16_t TFT_eSPI::drawString(const char *s, int32_t x, int32_t y) {
+  int16_t w = textWidth(s), h = fontHeight();
+  int32_t left = (datum == MR_DATUM) ? x - w : x;
+  int32_t top = (datum == TL_DATUM) ? y : y - h / 2;
+  // Padding wider than the text is cleared to the left of it (right-aligned)
+  if (padding > w) fillRect(left - (padding - w), top, padding - w, h, TFT_BLACK);
+  glyphs(left, top, s);
+  return w;
+}
+
+void TFT_eSPI::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t, uint32_t, uint8_t size) {
+  char s[2] = { (char)c, '\0' };
+  uint8_t keep = textSize;
+  textSize = size ? size : 1;
+  glyphs(x, y, s);
+  textSize = keep;
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *) {
+  if (w <= 0 || h <= 0) return;
+  setAddrWindow(x, y, w, h);
+  counters.calls++;
+  counters.pixels += (uint32_t)(w * h);
+  log(TftOp::PIXELS, x, y, w, h, (uint32_t)(w * h));
+}
+
+void TFT_eSPI::pushColors(uint16_t *, uint32_t len, bool) {
+  counters.calls++;
+  counters.pixels += len;
+  log(TftOp::PIXELS, 0, 0, (int32_t)len, 1, len);
+}
+
+void TFT_eSPI::pushBlock(uint16_t, uint32_t len) {
+  counters.calls++;
+  counters.pixels += len;
+  log(TftOp::PIXELS, 0, 0, (int32_t)len, 1, len);
+}
+
+void *TFT_eSprite::createSprite(int16_t w, int16_t h) {
+  width_ = w;
+  height_ = h;
+  buf.assign((size_t)w * h, 0);
+  return buf.data();
+}
+
+void TFT_eSprite::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > width_) w = width_ - x;
+  if (y + h > height_) h = height_ - y;
+  if (w <= 0 || h <= 0) return;
+  for (int32_t row = y; row < y + h; ++row) {
+    for (int32_t col = x; col < x + w; ++col) buf[(size_t)row * width_ + col] = (uint16_t)color;
+  }
+  parent->counters.ramPixels += (uint32_t)(w * h);
+}
+
+void TFT_eSprite::glyphs(int32_t, int32_t, const char *s) {
+  parent->counters.ramPixels += (uint32_t)(strlen(s) * 48 * textSize * textSize);
+}
+
+void TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+  for (int32_t row = 0; row < h; ++row) {
+    if (y + row < 0 || y + row >= height_) continue;
+    for (int32_t col = 0; col < w; ++col) {
+      if (x + col < 0 || x + col >= width_) continue;
+      buf[(size_t)(y + row) * width_ + x + col] = data[row * w + col];
+    }
+  }
+  parent->counters.ramPixels += (uint32_t)(w * h);
+}
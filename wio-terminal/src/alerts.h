@@ -0,0 +1,124 @@
+#pragma once
+#include <stdint.h>
+#include "config.h"
+#include "history.h"
+#include "metrics.h"
+
+// Widget and status dot colour while an alert is shown (TFT_RED)
+const uint16_t ALERT_COLOR = 0xF800;
+
+// What an active rule does to the dashboard
+enum AlertAction : uint8_t {
+  ALERT_RECOLOR = 1,   // draw the widget(s) on the rule's field in ALERT_COLOR
+  ALERT_BLINK = 2,     // blink the status dot
+  ALERT_BUZZ = 4,      // beep (only with ALERT_BUZZER)
+};
+
+// One threshold on a history field, in whole units (percent or degrees C). It
+// trips once the value has stayed at or above `on` for `sustainMs`, and clears
+// when it drops below `off`; in between it keeps its state (hysteresis).
+struct AlertRule {
+  const char *name;    // for the "# alert:" line
+  uint8_t field;       // MetricField below FIELD_LEGACY_COUNT (what history keeps)
+  uint8_t on, off;
+  uint32_t sustainMs;
+  uint8_t actions;     // AlertAction bits
+};
+
+constexpr AlertRule ALERT_RULES[] = {
+  { "CPU",    FIELD_CPU,     ALERT_LOAD_PCT,   ALERT_LOAD_PCT - ALERT_LOAD_HYST,   ALERT_LOAD_SUSTAIN_MS, ALERT_RECOLOR | ALERT_BLINK },
+  { "GPU",    FIELD_GPU,     ALERT_LOAD_PCT,   ALERT_LOAD_PCT - ALERT_LOAD_HYST,   ALERT_LOAD_SUSTAIN_MS, ALERT_RECOLOR | ALERT_BLINK },
+  { "TEMP",   FIELD_TEMP,    ALERT_CPU_TEMP_C, ALERT_CPU_TEMP_C - ALERT_TEMP_HYST, ALERT_TEMP_SUSTAIN_MS, ALERT_RECOLOR | ALERT_BLINK | ALERT_BUZZ },
+  { "G-TEMP", FIELD_GPUTEMP, ALERT_GPU_TEMP_C, ALERT_GPU_TEMP_C - ALERT_TEMP_HYST, ALERT_TEMP_SUSTAIN_MS, ALERT_RECOLOR | ALERT_BLINK | ALERT_BUZZ },
+};
+const int ALERT_COUNT = sizeof(ALERT_RULES) / sizeof(ALERT_RULES[0]);
+static_assert(ALERT_COUNT <= 8, "alert states are reported as an 8-bit mask");
+
+// Evaluates ALERT_RULES against one source's history. Every entry pushed since
+// the last update() is checked, not just the newest, so a dip between two frames
+// still clears or restarts a rule even when the renderer coalesced it away.
+//
+// What the screen shows lags the rule state on purpose: a rule's shown state
+// changes at most once per ALERT_REDRAW_MS, so a value flapping across the
+// threshold costs a bounded number of redraws whatever the sample rate.
+// Pure state, draws nothing; the display owner applies takeChanges().
+class AlertEngine {
+public:
+  // Check what arrived in `hist` since the last call. A different history (the
+  // shown source changed) or one that went backwards starts every rule afresh.
+  template <uint16_t N>
+  void update(const MetricHistory<N> &hist, uint32_t now) {
+    uint32_t total = hist.pushed();
+    if (&hist != (const void *)source || total < seen) {
+      reset();
+      source = &hist;
+      seen = total > 0 ? total - 1 : 0;   // judge from the newest sample on
+    }
+    uint32_t fresh = total - seen;
+    if (fresh > hist.available()) fresh = hist.available();
+    for (uint32_t age = fresh; age-- > 0;) {
+      for (int i = 0; i < ALERT_COUNT; ++i) step(i, hist.at(ALERT_RULES[i].field, (uint16_t)age), now);
+    }
+    seen = total;
+  }
+
+  // Rules whose shown state flips now (rate limited); `shown()` has the new state.
+  // Returns a mask of rule indexes.
+  uint8_t takeChanges(uint32_t now) {
+    uint8_t changed = 0;
+    for (int i = 0; i < ALERT_COUNT; ++i) {
+      State &s = state[i];
+      if (s.shown == s.active) continue;
+      if (s.shownEver && now - s.shownMs < ALERT_REDRAW_MS) continue;
+      s.shown = s.active;
+      s.shownMs = now;
+      s.shownEver = true;
+      changed |= (uint8_t)(1u << i);
+    }
+    return changed;
+  }
+
+  bool shown(int i) const { return state[i].shown; }
+  // AlertAction bits of every rule shown as active
+  uint8_t actions() const {
+    uint8_t a = 0;
+    for (int i = 0; i < ALERT_COUNT; ++i) if (state[i].shown) a |= ALERT_RULES[i].actions;
+    return a;
+  }
+  // Forget every rule; what is shown clears through takeChanges()
+  void reset() {
+    for (int i = 0; i < ALERT_COUNT; ++i) {
+      state[i].active = false;
+      state[i].overSince = 0;
+    }
+    source = nullptr;
+  }
+
+private:
+  struct State {
+    bool active = false;
+    bool shown = false;
+    bool shownEver = false;
+    uint32_t overSince = 0;   // 0 => not at or above `on`
+    uint32_t shownMs = 0;
+  };
+
+  void step(int i, uint8_t v, uint32_t now) {
+    if (v == MetricHistory<1>::HISTORY_NA) return;  // no reading: keep the state
+    const AlertRule &r = ALERT_RULES[i];
+    State &s = state[i];
+    if (v >= r.on) {
+      if (!s.overSince) s.overSince = now ? now : 1;
+      if (!s.active && now - s.overSince >= r.sustainMs) s.active = true;
+    } else if (v < r.off) {
+      s.active = false;
+      s.overSince = 0;
+    } else if (!s.active) {
+      s.overSince = 0;   // a dip into the band restarts the sustain window
+    }
+  }
+
+  State state[ALERT_COUNT];
+  const void *source = nullptr;
+  uint32_t seen = 0;
+};
@@ -0,0 +1,291 @@
+#pragma once
+
+// Build-time configuration. Every value can be overridden from platformio.ini, e.g.
+//   build_flags = -DWIO_USE_RTOS=1 -DRENDER_TASK_STACK=2048
+
+// --- FreeRTOS task mode ---
+// 0: everything runs in Arduino loop(); 1: ingest, render and BLE notify run as separate tasks
+#ifndef WIO_USE_RTOS
+#define WIO_USE_RTOS 0
+#endif
+
+// Task priorities (higher runs first) and stack sizes in words
+#ifndef INGEST_TASK_PRIO
+#define INGEST_TASK_PRIO 3
+#endif
+#ifndef INGEST_TASK_STACK
+#define INGEST_TASK_STACK 1024
+#endif
+#ifndef RENDER_TASK_PRIO
+#define RENDER_TASK_PRIO 2
+#endif
+#ifndef RENDER_TASK_STACK
+#define RENDER_TASK_STACK 1536
+#endif
+#ifndef NOTIFY_TASK_PRIO
+#define NOTIFY_TASK_PRIO 1
+#endif
+// The notify task also runs the BLE bring-up
+#ifndef NOTIFY_TASK_STACK
+#define NOTIFY_TASK_STACK 1536
+#endif
+
+// --- Serial input ---
+// Baud passed to Serial.begin(). The Wio Terminal's Serial is native USB CDC,
+// which runs at full USB speed whatever this says; it matters only for a UART build.
+#ifndef SERIAL_BAUD
+#define SERIAL_BAUD 115200
+#endif
+// Bytes buffered between the USB CDC endpoint and the parsers (power of two)
+#ifndef SERIAL_RX_RING_SIZE
+#define SERIAL_RX_RING_SIZE 4096
+#endif
+
+// --- Rendering ---
+// Upper bound on repaint rate; samples arriving faster are coalesced into the latest
+#ifndef RENDER_MAX_FPS
+#define RENDER_MAX_FPS 30
+#endif
+// Ease bar widths toward each new value over several frames instead of jumping
+#ifndef WIO_ANIMATE
+#define WIO_ANIMATE 0
+#endif
+// Easing time constant: about two thirds of a change is on screen after this long
+#ifndef ANIM_TAU_MS
+#define ANIM_TAU_MS 120
+#endif
+// Bar pixels one frame may push while animating (~1 ms of SPI at 40 MHz)
+#ifndef ANIM_FRAME_PX
+#define ANIM_FRAME_PX 2640
+#endif
+// Samples of per-field history kept on the device (1 byte per field per sample)
+#ifndef HISTORY_LEN
+#define HISTORY_LEN 320
+#endif
+// Print render scheduler counters to Serial every N ms as a "#"-prefixed line (0 = off)
+#ifndef RENDER_STATS_LOG_MS
+#define RENDER_STATS_LOG_MS 0
+#endif
+// Compose widgets in an off-screen band sprite and push only dirty rectangles
+#ifndef WIO_USE_SPRITES
+#define WIO_USE_SPRITES 1
+#endif
+// Draw values from a RAM atlas of pre-rendered glyphs, pushing only the digits that changed
+#ifndef WIO_GLYPH_CACHE
+#define WIO_GLYPH_CACHE 1
+#endif
+// Push sprite pixels to the panel with the SAMD51 DMAC when the LCD SERCOM allows it
+#ifndef WIO_USE_DMA
+#if defined(__SAMD51__)
+#define WIO_USE_DMA 1
+#else
+#define WIO_USE_DMA 0
+#endif
+#endif
+
+// --- BLE TX notifications ---
+// 1: legacy "CPU:..,TEMP:.." text; 0: binary FRAME_SAMPLE carrying only changed fields
+#ifndef BLE_NOTIFY_TEXT
+#define BLE_NOTIFY_TEXT 0
+#endif
+// A field is re-sent once it moves this many tenths from the last value notified
+#ifndef BLE_NOTIFY_DEADBAND_TENTHS
+#define BLE_NOTIFY_DEADBAND_TENTHS 5
+#endif
+// Send all fields at least this often so late subscribers catch up
+#ifndef BLE_NOTIFY_KEYFRAME_MS
+#define BLE_NOTIFY_KEYFRAME_MS 5000
+#endif
+// ATT MTU to size notifications for (payload limit is MTU - 3); 23 is the BLE minimum
+#ifndef BLE_NOTIFY_MTU
+#define BLE_NOTIFY_MTU 23
+#endif
+
+// --- Multiple hosts ---
+// PCs tracked at once (serial plus tagged BLE senders); each costs ~2.5 KB of RAM
+#ifndef MAX_HOSTS
+#define MAX_HOSTS 4
+#endif
+// Rotate to the next host's page this often when several are live (0 = buttons only)
+#ifndef HOST_PAGE_MS
+#define HOST_PAGE_MS 5000
+#endif
+
+// --- Pacing advice to hosts (FRAME_RATE) ---
+// Evaluate render backlog, link errors and screen state this often (0 = never advise)
+#ifndef RATE_ADVICE_MS
+#define RATE_ADVICE_MS 1000
+#endif
+// Bounds for the send interval the device asks for when it wants hosts to slow down
+#ifndef RATE_MIN_INTERVAL_MS
+#define RATE_MIN_INTERVAL_MS 100
+#endif
+#ifndef RATE_MAX_INTERVAL_MS
+#define RATE_MAX_INTERVAL_MS 4000
+#endif
+// Repeat non-default advice this often, for hosts that connected after it changed
+#ifndef RATE_RESEND_MS
+#define RATE_RESEND_MS 10000
+#endif
+
+// --- Latency probes (FRAME_STAMP / FRAME_ECHO) ---
+// Answer stamped samples with their parse and draw times
+#ifndef WIO_LATENCY
+#define WIO_LATENCY 1
+#endif
+// Stamped samples that can wait for a frame at once; more are echoed unmeasured
+#ifndef LATENCY_PENDING
+#define LATENCY_PENDING 8
+#endif
+// Task mode: BLE echoes queued for the notify task
+#ifndef LATENCY_ECHO_QUEUE
+#define LATENCY_ECHO_QUEUE 8
+#endif
+
+// --- Power ---
+// Sleep the core (WFI) between events and slow the CPU clock while the screen is off
+#ifndef WIO_LOW_POWER
+#if defined(__SAMD51__)
+#define WIO_LOW_POWER 1
+#else
+#define WIO_LOW_POWER 0
+#endif
+#endif
+// CPU clock divider while the LCD is off (120 MHz / 4 = 30 MHz)
+#ifndef LCD_OFF_CPU_DIV
+#define LCD_OFF_CPU_DIV 4
+#endif
+// Repaint rate while the LCD is off; the panel is kept current for an instant wake
+#ifndef LCD_OFF_MAX_FPS
+#define LCD_OFF_MAX_FPS 2
+#endif
+
+// --- Instrumentation ---
+// Cycle counters around parse, draw, notify and loop (see perf_counters.h); dump
+// them with "?perf" on Serial or show them with the middle top key
+#ifndef WIO_PERF
+#define WIO_PERF 1
+#endif
+
+// Loop-latency tracker, hardware watchdog and persistent stall log ("?stalls")
+#ifndef WIO_STALL_MONITOR
+#define WIO_STALL_MONITOR 1
+#endif
+// Watchdog period; a pass stuck this long resets the device (0 = no watchdog)
+#ifndef WDT_PERIOD_MS
+#if defined(__SAMD51__)
+#define WDT_PERIOD_MS 8000
+#else
+#define WDT_PERIOD_MS 0
+#endif
+#endif
+// Loop passes at least this long are logged
+#ifndef STALL_LOG_MS
+#define STALL_LOG_MS 250
+#endif
+// Entries kept in the stall log (backup RAM)
+#ifndef STALL_LOG_LEN
+#define STALL_LOG_LEN 8
+#endif
+
+// --- Trace record/replay ---
+// Record raw input to the SPI flash and replay it ("?trace ..." on Serial)
+#ifndef WIO_TRACE
+#if defined(__SAMD51__)
+#define WIO_TRACE 1
+#else
+#define WIO_TRACE 0
+#endif
+#endif
+#ifndef TRACE_PATH
+#define TRACE_PATH "/trace.bin"
+#endif
+// Recording ends on its own before the file would grow past this size
+#ifndef TRACE_MAX_BYTES
+#define TRACE_MAX_BYTES (1024UL * 1024UL)
+#endif
+// RAM staging for records before they are written to flash
+#ifndef TRACE_BUFFER
+#define TRACE_BUFFER 2048
+#endif
+// Records replayed per poll at max speed, so frames still get drawn
+#ifndef TRACE_REPLAY_BURST
+#define TRACE_REPLAY_BURST 32
+#endif
+
+// --- Background skin ---
+// Keep the static background (header, labels, bar slots) as an RLE image in the
+// SPI flash and stream it to the panel instead of redrawing it ("?skin ..." on Serial)
+#ifndef WIO_SKIN
+#if defined(__SAMD51__)
+#define WIO_SKIN 1
+#else
+#define WIO_SKIN 0
+#endif
+#endif
+#ifndef SKIN_PATH
+#define SKIN_PATH "/skin.rle"
+#endif
+// Panel rows rendered per pass while capturing the built-in background
+#ifndef SKIN_CAPTURE_ROWS
+#define SKIN_CAPTURE_ROWS 16
+#endif
+// Pixels per decode buffer (two of them) while streaming the image out
+#ifndef SKIN_LINE_PX
+#define SKIN_LINE_PX 1024
+#endif
+// Drop a "?skin put" upload after this long without data
+#ifndef SKIN_UPLOAD_TIMEOUT_MS
+#define SKIN_UPLOAD_TIMEOUT_MS 3000
+#endif
+
+// --- Threshold alerts ---
+// Rules in alerts.h: sustained full CPU/GPU load and high temperatures recolour
+// their widget and blink the status dot; temperatures can also beep
+#ifndef WIO_ALERTS
+#define WIO_ALERTS 1
+#endif
+// Load alert: at or above this percent for ALERT_LOAD_SUSTAIN_MS, clears ALERT_LOAD_HYST lower
+#ifndef ALERT_LOAD_PCT
+#define ALERT_LOAD_PCT 99
+#endif
+#ifndef ALERT_LOAD_HYST
+#define ALERT_LOAD_HYST 9
+#endif
+#ifndef ALERT_LOAD_SUSTAIN_MS
+#define ALERT_LOAD_SUSTAIN_MS 10000
+#endif
+// Temperature alerts, degrees C, clearing ALERT_TEMP_HYST lower
+#ifndef ALERT_CPU_TEMP_C
+#define ALERT_CPU_TEMP_C 90
+#endif
+#ifndef ALERT_GPU_TEMP_C
+#define ALERT_GPU_TEMP_C 85
+#endif
+#ifndef ALERT_TEMP_HYST
+#define ALERT_TEMP_HYST 5
+#endif
+#ifndef ALERT_TEMP_SUSTAIN_MS
+#define ALERT_TEMP_SUSTAIN_MS 3000
+#endif
+// Least time between two changes of what one alert shows (colour, "# alert:" line)
+#ifndef ALERT_REDRAW_MS
+#define ALERT_REDRAW_MS 1000
+#endif
+// Status dot blink half-period while an alert blinks it
+#ifndef ALERT_BLINK_MS
+#define ALERT_BLINK_MS 500
+#endif
+// Beep on alerts that ask for it: ALERT_BEEP_MS at ALERT_BEEP_HZ every ALERT_BEEP_EVERY_MS
+#ifndef ALERT_BUZZER
+#define ALERT_BUZZER 0
+#endif
+#ifndef ALERT_BEEP_HZ
+#define ALERT_BEEP_HZ 2000
+#endif
+#ifndef ALERT_BEEP_MS
+#define ALERT_BEEP_MS 80
+#endif
+#ifndef ALERT_BEEP_EVERY_MS
+#define ALERT_BEEP_EVERY_MS 2000
+#endif
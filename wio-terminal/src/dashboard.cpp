@@ -0,0 +1,302 @@
+#include "dashboard.h"
+#include <string.h>
+#include "lcd_dma.h"
+#include "perf_counters.h"
+
+WidgetPlan planWidget(const WidgetDesc &d, const WidgetCache &c, int16_t value) {
+  WidgetPlan p;
+  p.key = (value < 0) ? -1 : (int16_t)((value + 5) / 10);
+  p.barW = 0;
+  if (d.kind == WIDGET_BAR) {
+    int v = value < 0 ? 0 : (value > 1000 ? 1000 : value);
+    p.barW = (int16_t)(d.w * v / 1000);
+  }
+  // Update only when what is on screen would change
+  p.redraw = p.key != c.key || (d.kind == WIDGET_BAR && p.barW != c.barW);
+  return p;
+}
+
+int16_t easeBar(int16_t shown, int16_t target, uint32_t dtMs, uint32_t budgetPx) {
+  int gap = target - shown;
+  int mag = gap < 0 ? -gap : gap;
+  // 1 - e^(-dt/tau) ~= dt / (tau + dt): covers the whole gap only as dt grows
+  int step = (int)((uint32_t)mag * dtMs / (ANIM_TAU_MS + dtMs));
+  if (step < 1) step = 1;
+  int cap = (int)(budgetPx / BAR_H);
+  if (step > cap) step = cap;
+  if (step > mag) step = mag;
+  return (int16_t)(gap < 0 ? shown - step : shown + step);
+}
+
+void formatValue(char *buf, int16_t tenths, ValueFormat fmt) {
+  if (tenths < 0) { strcpy(buf, "N/A"); return; }
+  char *e = formatWhole(buf, tenths);
+  e[0] = (fmt == FMT_PERCENT) ? '%' : 'C';
+  e[1] = '\0';
+}
+
+// Right-aligned value text with background padding; returns the width it covers
+static int drawValueText(TFT_eSPI &gfx, const char *text, int y, int pad) {
+  gfx.setTextColor(TFT_WHITE, TFT_BLACK);
+  gfx.setTextDatum(MR_DATUM);
+  gfx.setTextPadding(pad);
+  gfx.drawString(text, VALUE_RIGHT, y);
+  gfx.setTextDatum(TL_DATUM);
+  int w = gfx.textWidth(text);
+  return w > pad ? w : pad;
+}
+
+Dashboard::Dashboard(TFT_eSPI &tft)
+  : tft(tft)
+#if WIO_USE_SPRITES
+  , band(&tft)
+#endif
+#if WIO_GLYPH_CACHE
+  , glyphs(tft)
+#endif
+{
+  for (int i = 0; i < WIDGET_COUNT; ++i) colors[i] = WIDGETS[i].color;
+}
+
+void Dashboard::begin() {
+#if WIO_USE_SPRITES
+  band.setColorDepth(16);
+  bandReady = band.createSprite(SCREEN_W, BAR_H) != nullptr;
+  if (bandReady) {
+    band.fillSprite(TFT_BLACK);
+    band.setTextSize(2);
+  }
+  lcdDma.begin();
+#endif
+#if WIO_GLYPH_CACHE
+  glyphs.begin();
+#endif
+}
+
+uint16_t layoutId() {
+  // FNV-1a over every field drawStatic() looks at
+  uint32_t h = 2166136261u;
+  for (int i = 0; i < WIDGET_COUNT; ++i) {
+    const WidgetDesc &d = WIDGETS[i];
+    for (const char *p = d.label; *p; ++p) h = (h ^ (uint8_t)*p) * 16777619u;
+    const int16_t geom[4] = { (int16_t)d.kind, d.x, d.y, d.w };
+    for (int k = 0; k < 4; ++k) h = (h ^ (uint16_t)geom[k]) * 16777619u;
+  }
+  uint16_t id = (uint16_t)(h ^ (h >> 16));
+  return id ? id : 1;
+}
+
+void Dashboard::drawStatic() {
+  settle();
+  drawStatic(tft, 0);
+}
+
+void Dashboard::drawStatic(TFT_eSPI &gfx, int yOff) {
+  gfx.setTextColor(TFT_WHITE, TFT_BLACK);
+  gfx.setTextSize(2);
+  for (int i = 0; i < WIDGET_COUNT; ++i) {
+    const WidgetDesc &d = WIDGETS[i];
+    // Labels
+    gfx.setCursor(PADDING, d.y - yOff);
+    gfx.print(d.label);
+    // Bar backgrounds
+    if (d.kind == WIDGET_BAR) gfx.fillRect(d.x, d.y - yOff, d.w, BAR_H, TFT_DARKGREY);
+  }
+}
+
+void Dashboard::invalidate() {
+  for (int i = 0; i < WIDGET_COUNT; ++i) cache[i] = WidgetCache();
+}
+
+void Dashboard::setColor(int i, uint16_t color) {
+  if (colors[i] == color) return;
+  colors[i] = color;
+  // Redrawn from an empty slot, so the whole fill comes out in the new colour
+  if (WIDGETS[i].kind == WIDGET_BAR) cache[i] = WidgetCache();
+}
+
+bool Dashboard::update(const Metrics &m, uint32_t now) {
+  tft.setTextSize(2);
+  uint32_t dt = now - lastUpdateMs;
+  lastUpdateMs = now;
+  // Shared by every bar this frame, in planning order
+  uint32_t budget = ANIM_FRAME_PX;
+  bool moving = false;
+  for (int i = 0; i < WIDGET_COUNT; ++i) {
+    const WidgetDesc &d = WIDGETS[i];
+    WidgetCache &c = cache[i];
+    int16_t value = m.v[d.field];
+    WidgetPlan p = planWidget(d, c, value);
+    if (!p.redraw) continue;
+    int16_t w = p.barW;
+    // A bar already on screen moves only part of the way; the value text is exact at once
+    if (animate && d.kind == WIDGET_BAR && c.barW >= 0 && w != c.barW) {
+      w = easeBar(c.barW, p.barW, dt, budget);
+      uint32_t spent = (uint32_t)(w > c.barW ? w - c.barW : c.barW - w) * BAR_H;
+      budget -= spent;
+      if (w != p.barW) moving = true;
+      if (w == c.barW && p.key == c.key) continue;
+    }
+    drawWidget(d, c, value, w);
+    c.key = p.key;
+    c.barW = w;
+    if (idleHook) idleHook();
+  }
+  return moving;
+}
+
+void Dashboard::settle() {
+  if (!dmaOpen) return;
+  lcdDma.wait();
+  tft.endWrite();
+  dmaOpen = false;
+}
+
+// Solid rectangle on the panel. With DMA the transfer is left running and the
+// transaction open until the next settle().
+void Dashboard::fillSpan(int x, int y, int w, int h, uint16_t color) {
+  settle();
+  if (w <= 0 || h <= 0) return;
+  tft.startWrite();
+  tft.setAddrWindow(x, y, w, h);
+  if (lcdDma.fill(color, (uint32_t)w * h)) {
+    dmaOpen = true;
+    return;
+  }
+  tft.pushBlock(color, (uint32_t)w * h);
+  tft.endWrite();
+}
+
+// Contiguous w x h pixels in panel byte order, left streaming like fillSpan()
+void Dashboard::pushPixels(int x, int y, int w, int h, const uint16_t *src) {
+  settle();
+  tft.startWrite();
+  tft.setAddrWindow(x, y, w, h);
+  if (lcdDma.start(src, w, w, h)) {
+    dmaOpen = true;
+    return;
+  }
+  tft.pushColors((uint16_t *)src, (uint32_t)w * h, false);
+  tft.endWrite();
+}
+
+// Push the band's dirty rectangles to screen row `screenY` and clear them. The
+// last rectangle is left streaming.
+void Dashboard::flushBand(int screenY) {
+#if WIO_USE_SPRITES
+  if (bandDirty.count() == 0) return;
+  settle();
+  const uint16_t *pixels = (const uint16_t *)band.getPointer();
+  bool streaming = false;
+  tft.startWrite();
+  for (int i = 0; i < bandDirty.count(); ++i) {
+    const Rect &r = bandDirty[i];
+    const uint16_t *src = pixels + r.y * SCREEN_W + r.x;
+    if (streaming) lcdDma.wait();
+    tft.setAddrWindow(r.x, screenY + r.y, r.w, r.h);
+    streaming = lcdDma.start(src, SCREEN_W, r.w, r.h);
+    if (!streaming) {
+      for (int row = 0; row < r.h; ++row) tft.pushColors((uint16_t *)src + row * SCREEN_W, r.w, false);
+    }
+  }
+  if (streaming) dmaOpen = true;
+  else tft.endWrite();
+  bandDirty.clear();
+#else
+  (void)screenY;
+#endif
+}
+
+// Compose `text` right-aligned from atlas glyphs, one slot per character. Only
+// slots whose character changed, or that the bar segment [overX, overX + overW)
+// was just painted over, reach the panel. Returns false (and forgets the slots)
+// when the atlas is unavailable or the text does not fit, so the caller falls
+// back to the text engine.
+bool Dashboard::drawGlyphs(const WidgetDesc &d, WidgetCache &c, const char *text, int overX, int overW) {
+#if WIO_GLYPH_CACHE
+  const int GW = GlyphAtlas::W, GH = GlyphAtlas::H;
+  int slots = d.textPad / GW;
+  if (slots > VALUE_SLOTS) slots = VALUE_SLOTS;
+  int len = (int)strlen(text);
+  bool fits = glyphs.ready() && len <= slots;
+  for (int i = 0; fits && i < len; ++i) fits = glyphs.glyph(text[i]) != nullptr;
+  if (!fits) {
+    memset(c.slots, 0, sizeof(c.slots));
+    return false;
+  }
+  int top = BAR_H / 2 - GH / 2;
+  for (int s = 0; s < slots; ++s) {
+    char ch = s < len ? text[len - 1 - s] : ' ';
+    int x = VALUE_RIGHT - (s + 1) * GW;
+    bool under = overW > 0 && x < overX + overW && overX < x + GW;
+    bool changed = ch != c.slots[s] || under;
+    const uint16_t *g = glyphs.glyph(ch);
+#if WIO_USE_SPRITES
+    if (bandReady) {
+      // The band is shared by every row, so the whole box is recomposed in RAM
+      // (a merged dirty rect may span unchanged slots); only changes are pushed
+      if (g) band.pushImage(x, top, GW, GH, g);
+      else band.fillRect(x, top, GW, GH, TFT_BLACK);
+      if (changed) bandDirty.add(x, top, GW, GH);
+      c.slots[s] = ch;
+      continue;
+    }
+#endif
+    if (changed) {
+      if (g) pushPixels(x, d.y + top, GW, GH, g);
+      else fillSpan(x, d.y + top, GW, GH, TFT_BLACK);
+    }
+    c.slots[s] = ch;
+  }
+  return true;
+#else
+  (void)d; (void)c; (void)text; (void)overX; (void)overW;
+  return false;
+#endif
+}
+
+// Draw one widget whose key and/or bar width changed. Bars redraw only the
+// grown/shrunk segment; the value goes out as changed glyphs, or as padded text
+// to erase the old value when the glyph cache can't show it.
+void Dashboard::drawWidget(const WidgetDesc &d, WidgetCache &c, int16_t value, int newW) {
+  PERF_SCOPE(d.kind == WIDGET_BAR ? PERF_DRAW_BAR : PERF_DRAW_VALUE);
+  char buf[16];
+  formatValue(buf, value, d.format);
+  int oldW = c.barW < 0 ? 0 : c.barW;
+  // Bar segment repainted this time, in screen x
+  int segX = d.x + (newW < oldW ? newW : oldW);
+  int segW = d.kind == WIDGET_BAR ? (newW < oldW ? oldW - newW : newW - oldW) : 0;
+
+#if WIO_USE_SPRITES
+  if (bandReady) {
+    // Compose the row in RAM, then push the changed bar segment and the text
+    // box (merged when they overlap)
+    if (d.kind == WIDGET_BAR) {
+      band.fillRect(d.x, 0, newW, BAR_H, colors[&d - WIDGETS]);
+      band.fillRect(d.x + newW, 0, d.w - newW, BAR_H, TFT_DARKGREY);
+      bandDirty.add(segX, 0, segW, BAR_H);
+    }
+    if (!drawGlyphs(d, c, buf, segX, segW)) {
+      int tw = drawValueText(band, buf, BAR_H / 2, d.textPad);
+      int th = band.fontHeight();
+      bandDirty.add(VALUE_RIGHT - tw, BAR_H / 2 - th / 2, tw, th);
+    }
+    flushBand(d.y);
+    return;
+  }
+#endif
+
+  if (d.kind == WIDGET_BAR && newW != oldW) {
+    if (newW > oldW) {
+      // Grow: fill the added segment
+      fillSpan(d.x + oldW, d.y, newW - oldW, BAR_H, colors[&d - WIDGETS]);
+    } else {
+      // Shrink: erase trailing segment to background (slot color)
+      fillSpan(d.x + newW, d.y, oldW - newW, BAR_H, TFT_DARKGREY);
+    }
+  }
+  if (!drawGlyphs(d, c, buf, segX, segW)) {
+    settle();
+    drawValueText(tft, buf, d.y + BAR_H / 2, d.textPad);
+  }
+}
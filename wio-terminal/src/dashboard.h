@@ -0,0 +1,144 @@
+#pragma once
+#include <TFT_eSPI.h>
+#include "config.h"
+#include "metrics.h"
+#include "dirty_rects.h"
+#include "glyph_atlas.h"
+
+// UI constants
+const int SCREEN_W = 320;
+const int SCREEN_H = 240;
+const int PADDING = 8;
+
+// Layout constants
+const int LABEL_W = 70;
+const int BAR_H = 22;
+const int ROW_Y0 = PADDING + 28;   // first widget row, below the header
+const int ROW_PITCH = 32;
+const int BAR_X = PADDING + LABEL_W + 6;
+const int BAR_W = SCREEN_W - BAR_X - PADDING;
+const int VALUE_RIGHT = SCREEN_W - PADDING;
+
+enum WidgetKind : uint8_t {
+  WIDGET_BAR,    // horizontal bar with the value right-aligned over its end
+  WIDGET_VALUE,  // value text only, optionally with a trend sparkline
+};
+
+enum ValueFormat : uint8_t {
+  FMT_PERCENT,   // "42%"
+  FMT_CELSIUS,   // "55C"
+};
+
+// One dashboard widget. The whole dashboard is this table: layout, static
+// drawing, cache reset and per-frame updates all iterate it, so adding a
+// sensor means adding a row here rather than a new code path.
+struct WidgetDesc {
+  const char *label;
+  uint8_t field;       // index into Metrics::v
+  WidgetKind kind;
+  ValueFormat format;
+  int16_t x, y, w;     // bar / sparkline area; rows are BAR_H tall
+  uint16_t color;      // bar fill or sparkline colour
+  uint8_t textPad;     // value text background width; whole glyphs of it are cached slots
+  int8_t spark;        // index into the sparkline array, -1 for none
+  uint8_t sparkLo, sparkHi; // sparkline range in whole units
+};
+
+#define ROW_Y(i) (ROW_Y0 + (i) * ROW_PITCH)
+const int SPARK_X = 100;
+const int SPARK_W = 140;
+const int SPARK_H = 20; // leaves a pixel clear of neighbouring rows
+
+constexpr WidgetDesc WIDGETS[] = {
+  { "CPU:",    FIELD_CPU,     WIDGET_BAR,   FMT_PERCENT, BAR_X,   ROW_Y(0), BAR_W,   TFT_GREEN,  48, -1, 0, 0 },
+  { "RAM:",    FIELD_RAM,     WIDGET_BAR,   FMT_PERCENT, BAR_X,   ROW_Y(1), BAR_W,   TFT_CYAN,   48, -1, 0, 0 },
+  { "GPU:",    FIELD_GPU,     WIDGET_BAR,   FMT_PERCENT, BAR_X,   ROW_Y(2), BAR_W,   TFT_ORANGE, 48, -1, 0, 0 },
+  { "G-TEMP:", FIELD_GPUTEMP, WIDGET_VALUE, FMT_CELSIUS, SPARK_X, ROW_Y(3), SPARK_W, TFT_ORANGE, 64,  0, 20, 100 },
+  { "TEMP:",   FIELD_TEMP,    WIDGET_VALUE, FMT_CELSIUS, SPARK_X, ROW_Y(4), SPARK_W, TFT_GREEN,  64,  1, 20, 100 },
+};
+const int WIDGET_COUNT = sizeof(WIDGETS) / sizeof(WIDGETS[0]);
+const int SPARK_COUNT = 2;
+// Most glyph slots any widget's value box holds
+const int VALUE_SLOTS = 6;
+
+// Per-widget draw cache, parallel to WIDGETS, to avoid full redraw flicker
+struct WidgetCache {
+  int16_t key = -1000;   // displayed whole number, -1 => N/A, -1000 => never drawn
+  int16_t barW = -1;     // last drawn bar width (pixels)
+  char slots[VALUE_SLOTS] = {}; // glyph shown in each value slot, rightmost first; 0 => unknown
+};
+
+// What a new value means for one widget's pixels. Pure: decides, draws nothing.
+struct WidgetPlan {
+  bool redraw;           // false => the panel already shows this
+  int16_t key;
+  int16_t barW;
+};
+WidgetPlan planWidget(const WidgetDesc &d, const WidgetCache &c, int16_t value);
+
+// Next bar width on the way from `shown` to `target`: ease-out with time constant
+// ANIM_TAU_MS over `dtMs`, at least one pixel, and no more than `budgetPx` pixels
+// of BAR_H-tall bar. Pure, like planWidget().
+int16_t easeBar(int16_t shown, int16_t target, uint32_t dtMs, uint32_t budgetPx);
+
+// Display text for a value in tenths; negative => N/A
+void formatValue(char *buf, int16_t tenths, ValueFormat fmt);
+
+// Fingerprint of what Dashboard::drawStatic() paints (labels and bar slots), so
+// a background captured from another layout is noticed. Never 0.
+uint16_t layoutId();
+
+// The widget rows on a panel. update() diffs a sample against the cache of what
+// is on the glass and issues draw calls only for what changed, composing each row
+// in a band sprite when there is RAM for it.
+class Dashboard {
+public:
+  explicit Dashboard(TFT_eSPI &tft);
+
+  // Band sprite and DMA; call after tft.init()
+  void begin();
+  // Labels and empty bar slots
+  void drawStatic();
+  // The same on `gfx`, whose top row is panel row `yOff` (a capture strip)
+  void drawStatic(TFT_eSPI &gfx, int yOff);
+  // Forget what is on the panel so the next update repaints every widget
+  void invalidate();
+  // Bar fill colour of widget `i` (e.g. while an alert holds); the bar is
+  // repainted whole on the next update
+  void setColor(int i, uint16_t color);
+  // Bring the widgets toward `m`; true while a bar is still animating and
+  // wants another frame
+  bool update(const Metrics &m, uint32_t now);
+  // Snap bars straight to their values (e.g. while nobody can see them)
+  void setAnimate(bool on) { animate = on && WIO_ANIMATE; }
+  // Called between widgets while their transfers stream, to keep input moving
+  void setIdleHook(void (*fn)()) { idleHook = fn; }
+  // Finish a transfer the last update() left streaming. Call before drawing
+  // anything else on the panel.
+  void settle();
+
+private:
+  void drawWidget(const WidgetDesc &d, WidgetCache &c, int16_t value, int newW);
+  bool drawGlyphs(const WidgetDesc &d, WidgetCache &c, const char *text, int overX, int overW);
+  void flushBand(int screenY);
+  void fillSpan(int x, int y, int w, int h, uint16_t color);
+  void pushPixels(int x, int y, int w, int h, const uint16_t *src);
+
+  TFT_eSPI &tft;
+#if WIO_USE_SPRITES
+  // Off-screen band holding one widget row. Widgets are composed here in full and
+  // only their dirty rectangles are pushed to the panel, in one SPI transaction.
+  TFT_eSprite band;
+  DirtyRects<4> bandDirty;
+#endif
+  bool bandReady = false;
+  bool dmaOpen = false;  // panel transaction held open for a DMA transfer in flight
+  bool animate = WIO_ANIMATE;
+  uint32_t lastUpdateMs = 0;
+  void (*idleHook)() = nullptr;
+#if WIO_GLYPH_CACHE
+  GlyphAtlas glyphs;
+#endif
+  WidgetCache cache[WIDGET_COUNT];
+  uint16_t colors[WIDGET_COUNT];   // bar fill, WIDGETS[i].color unless overridden
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <stdint.h>
+
+struct Rect {
+  int16_t x, y, w, h;
+};
+
+// Small fixed-capacity list of dirty rectangles. Overlapping or touching
+// rectangles are merged into their bounding box on insert, so a flush pushes
+// each pixel at most once and issues as few address windows as possible.
+template <int CAP>
+class DirtyRects {
+public:
+  void add(int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) return;
+    Rect r = { (int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h };
+    // Absorb every rect that touches r; repeat since the union can grow into others
+    bool merged = true;
+    while (merged) {
+      merged = false;
+      for (int i = 0; i < n; ++i) {
+        if (touches(rects[i], r)) {
+          r = unite(rects[i], r);
+          rects[i] = rects[--n];
+          merged = true;
+          break;
+        }
+      }
+    }
+    if (n < CAP) rects[n++] = r;
+    else rects[CAP - 1] = unite(rects[CAP - 1], r); // full: degrade to a larger box
+  }
+
+  void clear() { n = 0; }
+  int count() const { return n; }
+  const Rect &operator[](int i) const { return rects[i]; }
+
+private:
+  static bool touches(const Rect &a, const Rect &b) {
+    return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+  }
+  static Rect unite(const Rect &a, const Rect &b) {
+    int x0 = a.x < b.x ? a.x : b.x;
+    int y0 = a.y < b.y ? a.y : b.y;
+    int x1 = (a.x + a.w) > (b.x + b.w) ? (a.x + a.w) : (b.x + b.w);
+    int y1 = (a.y + a.h) > (b.y + b.h) ? (a.y + a.h) : (b.y + b.h);
+    Rect r = { (int16_t)x0, (int16_t)y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0) };
+    return r;
+  }
+
+  Rect rects[CAP];
+  int n = 0;
+};
@@ -0,0 +1,37 @@
+#include "flash_fs.h"
+
+#if WIO_USE_RTOS
+#include <Seeed_Arduino_FreeRTOS.h>
+static SemaphoreHandle_t flashMutex = nullptr;
+#endif
+
+#if defined(__SAMD51__) && (WIO_TRACE || WIO_SKIN)
+#include <Arduino.h>
+#include <Seeed_FS.h>
+#include "SFUD/Seeed_SFUD.h"
+
+bool flashFsMount() {
+  static bool tried = false, mounted = false;
+  if (!tried) {
+#if WIO_USE_RTOS
+    flashMutex = xSemaphoreCreateMutex();
+#endif
+    mounted = SPIFLASH.begin(104000000UL);
+    tried = true;
+  }
+  return mounted;
+}
+
+#else
+
+bool flashFsMount() { return false; }
+
+#endif
+
+#if WIO_USE_RTOS
+FlashLock::FlashLock() { if (flashMutex) xSemaphoreTake(flashMutex, portMAX_DELAY); }
+FlashLock::~FlashLock() { if (flashMutex) xSemaphoreGive(flashMutex); }
+#else
+FlashLock::FlashLock() {}
+FlashLock::~FlashLock() {}
+#endif
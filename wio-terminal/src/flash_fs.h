@@ -0,0 +1,17 @@
+#pragma once
+#include "config.h"
+
+// The SPI flash file system, shared by the trace store and the background skin.
+// Mounting is done once, by whichever asks first.
+bool flashFsMount();
+
+// Held around file system calls. With WIO_USE_RTOS the ingest task (trace,
+// skin upload) and the render task (skin blits) both touch the flash, and FatFs
+// is not reentrant; otherwise this compiles to nothing.
+class FlashLock {
+public:
+  FlashLock();
+  ~FlashLock();
+  FlashLock(const FlashLock &) = delete;
+  FlashLock &operator=(const FlashLock &) = delete;
+};
@@ -0,0 +1,25 @@
+#include "glyph_atlas.h"
+#include <string.h>
+
+static const char GLYPHS[] = "0123456789%CN/A";
+static const int GLYPH_COUNT = sizeof(GLYPHS) - 1;
+
+bool GlyphAtlas::begin() {
+  sheet.setColorDepth(16);
+  ok = sheet.createSprite(W, H * GLYPH_COUNT) != nullptr;
+  if (!ok) return false;
+  sheet.fillSprite(TFT_BLACK);
+  for (int i = 0; i < GLYPH_COUNT; ++i) {
+    // Opaque draw: the 6x8 cell including its spacing column, scaled by 2
+    sheet.drawChar(0, i * H, GLYPHS[i], TFT_WHITE, TFT_BLACK, 2);
+  }
+  pixels = (const uint16_t *)sheet.getPointer();
+  return true;
+}
+
+const uint16_t *GlyphAtlas::glyph(char c) const {
+  if (!ok || c == '\0') return nullptr;
+  const char *p = strchr(GLYPHS, c);
+  if (!p) return nullptr;
+  return pixels + (p - GLYPHS) * W * H;
+}
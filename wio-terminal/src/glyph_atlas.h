@@ -0,0 +1,26 @@
+#pragma once
+#include <TFT_eSPI.h>
+
+// Pre-rendered value glyphs: the digits, '%', 'C' and "N/A" in the dashboard's
+// value font (GLCD font at text size 2), white on black. Each glyph is a
+// contiguous W x H block in panel byte order, so it can be copied into a sprite
+// with pushImage() or streamed straight to an address window without going
+// through the text engine. Space is not stored; callers fill it with black.
+class GlyphAtlas {
+public:
+  static const int W = 12;
+  static const int H = 16;
+
+  explicit GlyphAtlas(TFT_eSPI &tft) : sheet(&tft) {}
+
+  // Render every glyph once; false when there is no RAM for the sheet
+  bool begin();
+  bool ready() const { return ok; }
+  // Pixels of `c`, or nullptr when it is not in the atlas
+  const uint16_t *glyph(char c) const;
+
+private:
+  TFT_eSprite sheet;  // the glyphs stacked vertically, one W x H cell each
+  const uint16_t *pixels = nullptr;
+  bool ok = false;
+};
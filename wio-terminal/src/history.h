@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+#include "metrics.h"
+
+// Compact on-device time series: the last N samples of every field, packed in
+// one byte each (whole percent or whole degrees C, 0..254; HISTORY_NA = N/A).
+template <uint16_t N>
+class MetricHistory {
+public:
+  static const uint8_t HISTORY_NA = 0xFF;
+
+  void push(const Metrics &m) {
+    uint16_t slot = (uint16_t)(total % N);
+    for (uint8_t f = 0; f < FIELD_LEGACY_COUNT; ++f) data[f][slot] = pack(m.v[f]);
+    total++;
+  }
+
+  // Sample `age` steps back (0 = newest); only valid for age < available()
+  uint8_t at(uint8_t field, uint16_t age) const {
+    return data[field][(uint16_t)((total - 1 - age) % N)];
+  }
+
+  uint16_t available() const { return total < N ? (uint16_t)total : N; }
+  // Monotonic count of samples ever pushed; readers diff it to find new entries
+  uint32_t pushed() const { return total; }
+  static uint16_t capacity() { return N; }
+  void clear() { total = 0; }
+
+private:
+  static uint8_t pack(int16_t tenths) {
+    if (tenths < 0) return HISTORY_NA;
+    int v = (tenths + 5) / 10;
+    return v > 254 ? 254 : (uint8_t)v;
+  }
+
+  uint8_t data[FIELD_LEGACY_COUNT][N];
+  uint32_t total = 0;
+};
@@ -0,0 +1,130 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+#include "protocol.h"
+#include "history.h"
+#include "latency.h"
+
+// Per-stream receive state. Each source owns one, so bytes from different hosts
+// can never meet in the same frame decoder or line parser.
+struct RxStream {
+  FrameDecoder frame;
+  LineParser line;
+  FieldSchema schema;
+  Metrics staged;              // FRAME_VALUES chunks accumulate here until complete
+  unsigned long lastCapsMs = 0;
+  StampSlot stamp;             // FRAME_STAMP waiting for the next sample
+  char cmd[16];                // "?" command line being received (serial only)
+  uint8_t cmdLen = 0;
+  bool cmdCr = false;          // last command ended on '\r': a '\n' right after is its CRLF
+
+  // Which parser takes byte `c`. Bytes inside a binary frame always belong to it,
+  // even a 0x3F ('?') value, length or CRC byte; only outside a frame does a '?'
+  // at the start of a Serial line begin a command.
+  enum Route : uint8_t { ROUTE_COMMAND, ROUTE_FRAME, ROUTE_LINE };
+  Route route(uint8_t c, bool fromSerial) const {
+    if (frame.active()) return ROUTE_FRAME;
+    if (fromSerial && (cmdLen > 0 || (line.atLineStart() && c == '?'))) return ROUTE_COMMAND;
+    if (line.atLineStart() && c == FRAME_SYNC) return ROUTE_FRAME;
+    return ROUTE_LINE;
+  }
+
+  void reset() {
+    frame.reset();
+    line.reset();
+    schema.id = schema.pendingId = schema.count = schema.received = 0;
+    staged = Metrics();
+    lastCapsMs = 0;
+    stamp.reset();
+    cmdLen = 0;
+    cmdCr = false;
+  }
+};
+
+// Source keys: BLE hosts use their FRAME_HOST id (0 = untagged writes), USB serial
+// has a key of its own outside that range. Replayed input is keyed like its live
+// counterpart plus SOURCE_REPLAY, so a replay never shares a parser, schema or page
+// with live bytes from the same host.
+const uint16_t SOURCE_SERIAL = 0x100;
+const uint16_t SOURCE_REPLAY = 0x200;
+
+// Everything the device keeps about one sending PC
+struct HostSource {
+  bool used = false;
+  uint16_t key = 0;
+  char name[HOST_NAME_MAX + 1] = "";
+  RxStream rx;
+  Metrics metrics;             // latest complete sample
+  MetricHistory<HISTORY_LEN> history;
+  bool receivedOnce = false;
+  unsigned long lastRxMillis = 0;
+
+  void setName(const uint8_t *text, size_t len) {
+    if (len > HOST_NAME_MAX) len = HOST_NAME_MAX;
+    memcpy(name, text, len);
+    name[len] = '\0';
+  }
+};
+
+// Fixed table of sources, claimed on first contact. When it is full the host
+// heard from least recently gives up its slot.
+template <int N>
+class SourceTable {
+public:
+  int find(uint16_t key) const {
+    for (int i = 0; i < N; ++i) {
+      if (slots[i].used && slots[i].key == key) return i;
+    }
+    return -1;
+  }
+
+  // Slot for `key`, claiming (and clearing) one if the key is new
+  int acquire(uint16_t key, unsigned long now) {
+    int i = find(key);
+    if (i >= 0) return i;
+    int victim = 0;
+    for (i = 0; i < N; ++i) {
+      if (!slots[i].used) { victim = i; break; }
+      if (now - slots[i].lastRxMillis > now - slots[victim].lastRxMillis) victim = i;
+    }
+    HostSource &s = slots[victim];
+    s.rx.reset();
+    s.metrics = Metrics();
+    s.history.clear();
+    s.name[0] = '\0';
+    s.receivedOnce = false;
+    s.lastRxMillis = now;
+    s.key = key;
+    s.used = true;
+    return victim;
+  }
+
+  // Sources worth a page: those that delivered at least one sample
+  int pageCount() const {
+    int n = 0;
+    for (int i = 0; i < N; ++i) n += slots[i].used && slots[i].receivedOnce;
+    return n;
+  }
+  // 1-based position of slot `i` among the pages
+  int pageNumber(int i) const {
+    int n = 0;
+    for (int j = 0; j <= i && j < N; ++j) n += slots[j].used && slots[j].receivedOnce;
+    return n;
+  }
+  // Next page after slot `i` in direction `dir` (+1/-1), wrapping; -1 if there is none
+  int nextPage(int i, int dir) const {
+    for (int step = 1; step <= N; ++step) {
+      int j = ((i + dir * step) % N + N) % N;
+      if (slots[j].used && slots[j].receivedOnce) return j;
+    }
+    return -1;
+  }
+
+  HostSource &operator[](int i) { return slots[i]; }
+  const HostSource &operator[](int i) const { return slots[i]; }
+  static int capacity() { return N; }
+
+private:
+  HostSource slots[N];
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <stdint.h>
+#include "config.h"
+#include "protocol.h"
+
+static inline uint16_t latencyMs16(uint32_t ms) { return ms > 0xFFFF ? 0xFFFF : (uint16_t)ms; }
+
+// One stamped sample on its way to the screen and back to its host
+struct LatencySample {
+  uint16_t seq = 0;
+  uint32_t hostMs = 0;
+  uint32_t parsedMs = 0;    // device clock
+  uint16_t drawMs = 0;      // parse to the end of the frame that drew it
+  uint8_t lost = 0;
+  uint8_t flags = 0;        // EchoFlag bits
+  bool serial = false;      // answer on Serial rather than BLE
+
+  // The echo as it goes out at `now`
+  EchoReport report(uint32_t now) const {
+    EchoReport e;
+    e.seq = seq;
+    e.hostMs = hostMs;
+    e.flags = flags;
+    e.lost = lost;
+    e.drawMs = drawMs;
+    e.sendMs = latencyMs16(now - parsedMs);
+    return e;
+  }
+};
+
+// Per-stream probe state: the last FRAME_STAMP waits here for the sample it tags.
+// A second stamp before any sample replaces the first, which then never echoes.
+class StampSlot {
+public:
+  void arm(uint16_t seq, uint32_t hostMs) {
+    uint16_t gap = (uint16_t)(seq - nextSeq);
+    // A sequence number behind the last one means the sender restarted, not loss
+    pending.lost = (haveSeq && gap < 0x8000) ? (uint8_t)(gap > 0xFF ? 0xFF : gap) : 0;
+    pending.seq = seq;
+    pending.hostMs = hostMs;
+    nextSeq = (uint16_t)(seq + 1);
+    haveSeq = armed = true;
+  }
+
+  // Hand the waiting stamp to the sample completed at `now`; false if there is none
+  bool take(uint32_t now, bool serial, LatencySample &out) {
+    if (!armed) return false;
+    armed = false;
+    out = pending;
+    out.parsedMs = now;
+    out.serial = serial;
+    return true;
+  }
+
+  void reset() { armed = haveSeq = false; }
+
+private:
+  LatencySample pending;
+  uint16_t nextSeq = 0;
+  bool armed = false;
+  bool haveSeq = false;
+};
+
+// Stamped samples of the shown source between being submitted to the renderer and
+// the end of the frame that drew them. Pure state; the caller provides the locking.
+template <uint8_t N>
+class LatencyQueue {
+public:
+  // A sample went to the renderer, stamped or not (`s` null): everything still
+  // waiting is superseded by it. False if `s` did not fit; nothing is queued then.
+  bool submitted(const LatencySample *s) {
+    for (uint8_t i = 0; i < count; ++i) buf[(head + i) % N].flags |= ECHO_SUPERSEDED;
+    if (!s) return true;
+    if (count == N) return false;
+    buf[(head + count) % N] = *s;
+    count++;
+    return true;
+  }
+
+  uint8_t size() const { return count; }
+
+  // Take the oldest `n` (at most size()) as finished at `now`, adding `flags`.
+  // Returns how many were copied to `out`, which must hold N.
+  uint8_t drawn(uint8_t n, uint32_t now, LatencySample *out, uint8_t flags = 0) {
+    if (n > count) n = count;
+    for (uint8_t i = 0; i < n; ++i) {
+      LatencySample &s = out[i];
+      s = buf[head];
+      s.flags |= flags;
+      s.drawMs = (s.flags & ECHO_OFFSCREEN) ? 0 : latencyMs16(now - s.parsedMs);
+      head = (uint8_t)((head + 1) % N);
+    }
+    count = (uint8_t)(count - n);
+    return n;
+  }
+
+private:
+  LatencySample buf[N];
+  uint8_t head = 0;
+  uint8_t count = 0;
+};
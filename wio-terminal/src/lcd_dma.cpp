@@ -0,0 +1,124 @@
+#include "lcd_dma.h"
+#include "config.h"
+
+LcdDma lcdDma;
+
+#if defined(__SAMD51__) && WIO_USE_DMA
+#include <Arduino.h>
+
+// Wio Terminal drives the LCD from SERCOM7 (SPI3)
+#ifndef LCD_DMA_SERCOM
+#define LCD_DMA_SERCOM SERCOM7
+#define LCD_DMA_TRIGGER SERCOM7_DMAC_ID_TX
+#endif
+#ifndef LCD_DMA_CHANNEL
+#define LCD_DMA_CHANNEL 0
+#endif
+
+// Descriptor tables are only used when nobody else has set up the DMAC yet
+static DmacDescriptor dmaBase[DMAC_CH_NUM] __attribute__((aligned(16)));
+static DmacDescriptor dmaWriteback[DMAC_CH_NUM] __attribute__((aligned(16)));
+// Rows after the first; the first lives in the channel's slot of the base table
+static DmacDescriptor rowDesc[LcdDma::MAX_ROWS] __attribute__((aligned(16)));
+// Source of every fill descriptor, in panel byte order
+static uint16_t fillLine[LcdDma::FILL_LINE];
+static uint16_t fillLineColor;
+static bool fillLineValid = false;
+
+static DmacDescriptor *baseTable() { return (DmacDescriptor *)DMAC->BASEADDR.reg; }
+
+bool LcdDma::begin() {
+  Sercom *sercom = LCD_DMA_SERCOM;
+  // Only take over if the LCD driver has the SERCOM running as SPI master
+  if (!sercom->SPI.CTRLA.bit.ENABLE || sercom->SPI.CTRLA.bit.MODE != 0x3) return false;
+
+  MCLK->AHBMASK.bit.DMAC_ = 1;
+  if (!DMAC->CTRL.bit.DMAENABLE) {
+    DMAC->CTRL.bit.SWRST = 1;
+    while (DMAC->CTRL.bit.SWRST) {}
+    DMAC->BASEADDR.reg = (uint32_t)dmaBase;
+    DMAC->WRBADDR.reg = (uint32_t)dmaWriteback;
+    DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+  }
+
+  DmacChannel &ch = DMAC->Channel[LCD_DMA_CHANNEL];
+  ch.CHCTRLA.bit.ENABLE = 0;
+  while (ch.CHCTRLA.bit.ENABLE) {}
+  ch.CHCTRLA.bit.SWRST = 1;
+  while (ch.CHCTRLA.bit.SWRST) {}
+  ch.CHCTRLA.reg = DMAC_CHCTRLA_TRIGSRC(LCD_DMA_TRIGGER) | DMAC_CHCTRLA_TRIGACT_BURST |
+                   DMAC_CHCTRLA_BURSTLEN_SINGLE;
+  ch.CHPRILVL.reg = 0;
+  ok = true;
+  return true;
+}
+
+static void fillDesc(DmacDescriptor *d, const uint16_t *row, int w, DmacDescriptor *next) {
+  uint32_t bytes = (uint32_t)w * 2;
+  d->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC |
+                  DMAC_BTCTRL_BLOCKACT_NOACT;
+  d->BTCNT.reg = bytes;
+  d->SRCADDR.reg = (uint32_t)row + bytes; // end address when SRCINC is set
+  d->DSTADDR.reg = (uint32_t)&LCD_DMA_SERCOM->SPI.DATA.reg;
+  d->DESCADDR.reg = (uint32_t)next;
+}
+
+bool LcdDma::start(const uint16_t *src, int stride, int w, int h) {
+  if (!ok || w <= 0 || h <= 0 || h > MAX_ROWS + 1) return false;
+  wait();
+  DmacDescriptor *first = &baseTable()[LCD_DMA_CHANNEL];
+  for (int r = h - 1; r >= 1; --r) {
+    fillDesc(&rowDesc[r - 1], src + r * stride, w, r + 1 < h ? &rowDesc[r] : nullptr);
+  }
+  fillDesc(first, src, w, h > 1 ? &rowDesc[0] : nullptr);
+  __DSB();
+  DMAC->Channel[LCD_DMA_CHANNEL].CHCTRLA.bit.ENABLE = 1;
+  return true;
+}
+
+bool LcdDma::fill(uint16_t color, uint32_t count) {
+  uint32_t chunks = (count + FILL_LINE - 1) / FILL_LINE;
+  if (!ok || count == 0 || chunks > (uint32_t)MAX_ROWS + 1) return false;
+  wait();
+  uint16_t panel = (uint16_t)((color >> 8) | (color << 8));
+  if (!fillLineValid || fillLineColor != panel) {
+    for (int i = 0; i < FILL_LINE; ++i) fillLine[i] = panel;
+    fillLineColor = panel;
+    fillLineValid = true;
+  }
+  // Every descriptor reads the same line; only the last one is short
+  int last = (int)(count - (chunks - 1) * FILL_LINE);
+  DmacDescriptor *first = &baseTable()[LCD_DMA_CHANNEL];
+  for (int c = (int)chunks - 1; c >= 1; --c) {
+    fillDesc(&rowDesc[c - 1], fillLine, c == (int)chunks - 1 ? last : FILL_LINE,
+             c + 1 < (int)chunks ? &rowDesc[c] : nullptr);
+  }
+  fillDesc(first, fillLine, chunks == 1 ? last : FILL_LINE, chunks > 1 ? &rowDesc[0] : nullptr);
+  __DSB();
+  DMAC->Channel[LCD_DMA_CHANNEL].CHCTRLA.bit.ENABLE = 1;
+  return true;
+}
+
+bool LcdDma::busy() const {
+  return ok && DMAC->Channel[LCD_DMA_CHANNEL].CHCTRLA.bit.ENABLE;
+}
+
+void LcdDma::wait() {
+  if (!ok) return;
+  while (DMAC->Channel[LCD_DMA_CHANNEL].CHCTRLA.bit.ENABLE) {}
+  Sercom *sercom = LCD_DMA_SERCOM;
+  while (!sercom->SPI.INTFLAG.bit.TXC) {}
+  // Discard whatever the receiver clocked in while we were streaming
+  while (sercom->SPI.INTFLAG.bit.RXC) (void)sercom->SPI.DATA.reg;
+  sercom->SPI.STATUS.bit.BUFOVF = 1;
+}
+
+#else
+
+bool LcdDma::begin() { return false; }
+bool LcdDma::start(const uint16_t *, int, int, int) { return false; }
+bool LcdDma::fill(uint16_t, uint32_t) { return false; }
+bool LcdDma::busy() const { return false; }
+void LcdDma::wait() {}
+
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+
+// Minimal SAMD51 DMAC driver for streaming pixels to the LCD SPI SERCOM.
+// The caller owns the panel transaction: open it with tft.startWrite() and
+// setAddrWindow(), hand the pixel rows to start(), and call wait() before any
+// other tft call or endWrite(). Pixel data must already be in panel byte order
+// (as in a 16-bit TFT_eSprite buffer).
+//
+// Transfers run in the background: start() and fill() return as soon as the
+// channel is armed, so the CPU can parse input while the panel is fed.
+//
+// On other targets, or when the SERCOM is not in SPI master mode, ready()
+// stays false and callers fall back to tft.pushColors() / pushBlock().
+class LcdDma {
+public:
+  bool begin();
+  bool ready() const { return ok; }
+
+  // Queue `h` rows of `w` pixels, each starting `stride` pixels after the previous
+  bool start(const uint16_t *src, int stride, int w, int h);
+  // Queue `count` pixels of one RGB565 colour, repeated from a small line buffer
+  bool fill(uint16_t color, uint32_t count);
+  bool busy() const;
+  // Block until the last byte has left the shift register
+  void wait();
+
+  static const int MAX_ROWS = 32;
+  // Pixels per fill descriptor; a fill may span MAX_ROWS + 1 of them
+  static const int FILL_LINE = 256;
+
+private:
+  bool ok = false;
+};
+
+extern LcdDma lcdDma;
@@ -1,5 +1,21 @@
 #include <Arduino.h>
 #include <TFT_eSPI.h>
+#include "config.h"
+#include "metrics.h"
+#include "protocol.h"
+#include "spsc_ring.h"
+#include "render_scheduler.h"
+#include "dashboard.h"
+#include "sparkline.h"
+#include "host_sources.h"
+#include "rate_advisor.h"
+#include "power.h"
+#include "perf_counters.h"
+#include "trace.h"
+#include "stall_monitor.h"
+#include "skin.h"
+#include "alerts.h"
+#include "latency.h"
 
 // Prefer Seeed rpcBLE (rpcBLEDevice) when available; fall back to BluetoothSerial (ESP32), else provide a no-op stub
 #ifdef __has_include
@@ -12,9 +28,6 @@
     // Use rpcBLE (Seeed wrapper) which exposes ESP32-style BLE APIs
     #define RPC_BLE_SUPPORTED 1
   static BLECharacteristic* metricsCharacteristic = nullptr;
-  // Globals for incoming BLE RX packet
-  static std::string lastBlePacket;
-  static volatile bool haveBlePacket = false;
   static const bool BT_AVAILABLE = true;
 #  elif __has_include(<BluetoothSerial.h>)
 #    include <BluetoothSerial.h>
@@ -40,292 +53,342 @@
   static const bool BT_AVAILABLE = true;
 #endif
 
+#if defined(RPC_BLE_SUPPORTED)
+// Incoming BLE RX packets: pushed by the rpcBLE write callback, drained by loop()
+#ifndef BLE_RX_RING_SIZE
+#define BLE_RX_RING_SIZE 4096
+#endif
+static PacketRing<BLE_RX_RING_SIZE> bleRxRing;
+#endif
+
+// Incoming Serial bytes, pulled from the USB CDC endpoint in bulk by pumpSerial()
+static ByteRing<SERIAL_RX_RING_SIZE> serialRxRing;
+
+#if WIO_USE_RTOS
+#include <Seeed_Arduino_FreeRTOS.h>
+#endif
+
+// The stall monitor follows the loop, or the render task in RTOS mode; time spent
+// on the other tasks is not attributed to a phase
+#if WIO_USE_RTOS
+#define LOOP_STALL_SCOPE(p) do {} while (0)
+#else
+#define LOOP_STALL_SCOPE(p) STALL_SCOPE(p)
+#endif
+
 TFT_eSPI tft = TFT_eSPI();
 
-// UI constants
-const int SCREEN_W = 320;
-const int SCREEN_H = 240;
-const int PADDING = 8;
-
-struct Metrics {
-  float cpu = 0.0f;
-  float tempC = -1.0f; // -1 => N/A
-  float ram = 0.0f;
-  float gpu = -1.0f;   // -1 => N/A
-  float gpuTempC = 0.0f;
-};
-
-Metrics current;
-String lineBuf;
-String lastLineShown;
-bool receivedOnce = false;
-unsigned long lastRxMillis = 0;
+// Every sending PC has its own slot; the screen shows one of them at a time
+SourceTable<MAX_HOSTS> sources;
+int shownSlot = -1;            // slot on screen, -1 until the first sample
+uint16_t shownKey = 0;         // key it had when shown, to notice the slot being reused
+bool receivedOnce = false;     // any source
+unsigned long lastRxMillis = 0; // newest sample from any source
+
+// Boot milestones, ms since reset; each is printed as a "# boot:" line once reached
+struct BootTimes {
+  uint32_t screenMs = 0;       // layout on the panel, serial ingest live
+  uint32_t bleMs = 0;          // radio advertising
+  uint32_t firstSampleMs = 0;
+} bootTimes;
+
+// Radio bring-up progress (see bleBringUpStep)
+enum BleStage : uint8_t { BLE_INIT, BLE_SERVICE, BLE_ADVERTISE, BLE_UP };
+static volatile BleStage bleStage = BLE_INIT;
+static bool bleUp() { return bleStage == BLE_UP; }
 
 // LCD sleep/wake on no data
 bool isLcdOn = true;
+bool lcdOffByUser = false;      // screen turned off with the button: data does not wake it
+unsigned long lastUserMillis = 0;
 const unsigned long LCD_SLEEP_TIMEOUT_MS = 60UL * 1000UL; // 60 seconds
 
-// Layout constants
-const int LABEL_W = 70;
-const int BAR_H = 22;
-
-// Precomputed Y positions
-int Y_CPU = 0;
-int Y_GPU = 0;
-int Y_RAM = 0;
-int Y_GPUTEMP = 0;
-int Y_TEMP = 0; 
+Dashboard dashboard(tft);
 
-// Last drawn bar widths (pixels)
-int lastCpuW = -1;
-int lastRamW = -1;
-int lastGpuW = -1;
+// Trend graphs for value widgets that ask for one, fed from the shown source's history
+Sparkline sparks[SPARK_COUNT] = { { &tft }, { &tft } };
 
-static inline void barGeom(int y, int &barX, int &barW) {
-  int x = PADDING;
-  barX = x + LABEL_W + 6;
-  barW = SCREEN_W - barX - PADDING;
+static void setupSparklines() {
+  for (int i = 0; i < WIDGET_COUNT; ++i) {
+    const WidgetDesc &d = WIDGETS[i];
+    if (d.spark < 0) continue;
+    sparks[d.spark].begin(d.field, d.x, d.y + (BAR_H - SPARK_H) / 2, d.w, SPARK_H, d.sparkLo, d.sparkHi, d.color);
+  }
 }
 
-void drawStaticLabelsAndSlots() {
-  // Labels
-  tft.setTextColor(TFT_WHITE, TFT_BLACK);
-  tft.setTextSize(2);
-  tft.setCursor(PADDING, Y_CPU);
-  tft.print("CPU:");
-  tft.setCursor(PADDING, Y_RAM);
-  tft.print("RAM:");
-  tft.setCursor(PADDING, Y_GPU);
-  tft.print("GPU:");
-  tft.setCursor(PADDING, Y_GPUTEMP);
-  tft.print("G-TEMP:");
-  tft.setCursor(PADDING, Y_TEMP);
-  tft.print("TEMP:");
-
-  // Bar backgrounds
-  int bx, bw;
-  barGeom(Y_CPU, bx, bw);
-  tft.fillRect(bx, Y_CPU, bw, BAR_H, TFT_DARKGREY);
-  barGeom(Y_RAM, bx, bw);
-  tft.fillRect(bx, Y_RAM, bw, BAR_H, TFT_DARKGREY);
-  barGeom(Y_GPU, bx, bw);
-  tft.fillRect(bx, Y_GPU, bw, BAR_H, TFT_DARKGREY);
-}
-
-void updateBarFill(int y, float value, uint16_t color, int &lastWRef) {
-  int bx, bw; barGeom(y, bx, bw);
-  float v = value; if (v < 0) v = 0; if (v > 100) v = 100;
-  int newW = (int)(bw * (v / 100.0f));
-  if (lastWRef < 0) lastWRef = 0; // initial
-  if (newW == lastWRef) return;
-  if (newW > lastWRef) {
-    // Grow: fill the added segment
-    tft.fillRect(bx + lastWRef, y, newW - lastWRef, BAR_H, color);
-  } else {
-    // Shrink: erase trailing segment to background (slot color)
-    tft.fillRect(bx + newW, y, lastWRef - newW, BAR_H, TFT_DARKGREY);
-  }
-  lastWRef = newW;
+void drawHeader(TFT_eSPI &gfx, int yOff) {
+  // Draw static header only once or on demand (leave background intact elsewhere)
+  gfx.setTextColor(TFT_WHITE, TFT_BLACK);
+  gfx.setTextSize(2);
+  gfx.setCursor(PADDING, PADDING - yOff);
+  gfx.println("Wio PC Monitor");
+  gfx.drawLine(PADDING, PADDING + 20 - yOff, SCREEN_W - PADDING, PADDING + 20 - yOff, TFT_DARKGREY);
+}
 
-  // Draw value text at right with padding to erase previous text cleanly
-  char buf[16];
-  snprintf(buf, sizeof(buf), "%.0f%%", value);
-  tft.setTextColor(TFT_WHITE, TFT_BLACK);
-  tft.setTextDatum(MR_DATUM);
-  tft.setTextPadding(44);
-  tft.drawString(buf, SCREEN_W - PADDING, y + BAR_H/2);
-  tft.setTextDatum(TL_DATUM);
+// The built-in background, on the panel or on a skin capture strip
+static void drawBackground(TFT_eSPI &gfx, int yOff) {
+  drawHeader(gfx, yOff);
+  dashboard.drawStatic(gfx, yOff);
 }
 
-void drawHeader() {
-  // Draw static header only once or on demand (leave background intact elsewhere)
-  tft.setTextColor(TFT_WHITE, TFT_BLACK);
+void drawStaticLayoutOnce() {
+  dashboard.settle();
+#if WIO_SKIN
+  // One streamed blit from flash; the draw calls only run until there is an image
+  bool blitted = skin.draw(tft, 0, SCREEN_H);
+#else
+  bool blitted = false;
+#endif
+  if (!blitted) {
+    tft.fillScreen(TFT_BLACK);
+    // Draw header, labels and bar slots once
+    drawBackground(tft, 0);
+#if WIO_SKIN
+    skin.capture(tft, drawBackground);
+#endif
+  }
+  // Value text is drawn at this size, however the background got there
   tft.setTextSize(2);
-  tft.setCursor(PADDING, PADDING);
-  tft.println("Wio PC Monitor");
-  tft.drawLine(PADDING, PADDING + 20, SCREEN_W - PADDING, PADDING + 20, TFT_DARKGREY);
 }
 
-void drawTemp(int y, float tempC) {
-  tft.setTextColor(TFT_WHITE, TFT_BLACK);
-  tft.setTextDatum(MR_DATUM);
-  if (tempC < 0) {
-    tft.setTextPadding(64);
-    tft.drawString("N/A", SCREEN_W - PADDING, y);
-  } else {
-    char buf[24];
-    snprintf(buf, sizeof(buf), "%.0fC", tempC);
-    tft.setTextPadding(64);
-    tft.drawString(buf, SCREEN_W - PADDING, y);
-  }
-  tft.setTextDatum(TL_DATUM);
+// Labels and empty bar slots under the widget rows, e.g. after the overlay
+static void drawRowsBackground() {
+#if WIO_SKIN
+  dashboard.settle();
+  if (skin.draw(tft, ROW_Y0, ROW_Y(WIDGET_COUNT) - ROW_Y0)) return;
+#endif
+  dashboard.drawStatic();
 }
 
-// Cached last drawn values to avoid full redraw flicker
-struct LastDrawn {
-  int cpu = -1000;
-  int ram = -1000;
-  int gpu = -1000;
-  int tempC = -1000;     // tenths to avoid float compares
-  int gpuTempC = -1000;
-} lastDrawn;
+#if WIO_ALERTS
+// Threshold rules on the shown source (display owner only)
+AlertEngine alerts;
+#endif
 
-void drawStaticLayoutOnce() {
-  tft.fillScreen(TFT_BLACK);
-  drawHeader();
-  // Compute Y layout
-  Y_CPU = PADDING + 28;
-  Y_RAM = Y_CPU + 32;
-  Y_GPU = Y_RAM + 32;
-  Y_GPUTEMP = Y_GPU + 32;
-  Y_TEMP = Y_GPUTEMP + 32;
-  // Draw labels and bar slots once
-  drawStaticLabelsAndSlots();
+// Cached status strip state, same idea as LastDrawn: repaint only what changed
+struct LastStatus {
+  int32_t dot = -1;      // status dot colour, -1 => never drawn
+  char left[32] = "";
+  char right[8] = "";
+} lastStatus;
+
+// Redraw one status text field only when its content differs from the cache
+static void drawStatusText(int x, int y, int w, const char *text, uint16_t color, char *cache, size_t cap) {
+  if (strncmp(cache, text, cap) == 0) return;
+  tft.fillRect(x, y, w, 8, TFT_BLACK);
+  tft.setCursor(x, y);
+  tft.setTextColor(color, TFT_BLACK);
+  tft.setTextSize(1);
+  tft.print(text);
+  tft.setTextColor(TFT_WHITE, TFT_BLACK);
+  strncpy(cache, text, cap - 1);
+  cache[cap - 1] = '\0';
+}
+
+// Status label for the shown source: its name and page when there is more than one
+static void sourceLabel(char *buf, size_t cap) {
+  if (!receivedOnce || shownSlot < 0) { strncpy(buf, "Waiting for data...", cap); return; }
+  const HostSource &src = sources[shownSlot];
+  int pages = sources.pageCount();
+  if (pages <= 1 && src.name[0] == '\0') { strncpy(buf, " ", cap); return; }
+  const char *name = src.name;
+  char fallback[12];
+  if (name[0] == '\0') {
+    uint16_t key = src.key & ~SOURCE_REPLAY;
+    if (key == SOURCE_SERIAL) name = "USB";
+    else { snprintf(fallback, sizeof(fallback), "BLE %u", (unsigned)key); name = fallback; }
+  }
+  char replayName[20];
+  if (src.key & SOURCE_REPLAY) {
+    snprintf(replayName, sizeof(replayName), "REPLAY %s", name);
+    name = replayName;
+  }
+  if (pages > 1) snprintf(buf, cap, "%s  %d/%d", name, sources.pageNumber(shownSlot), pages);
+  else snprintf(buf, cap, "%s", name);
 }
 
 void drawStatus() {
+  PERF_SCOPE(PERF_STATUS);
   int y = SCREEN_H - 28;
-  tft.fillRect(PADDING, y - 4, SCREEN_W - 2 * PADDING, 28, TFT_BLACK);
-  bool fresh = (millis() - lastRxMillis) < 2500;
+  unsigned long last = shownSlot >= 0 ? sources[shownSlot].lastRxMillis : lastRxMillis;
+  bool fresh = receivedOnce && (millis() - last) < 2500;
   uint16_t dot = fresh ? TFT_GREEN : TFT_RED;
-  tft.fillCircle(PADDING + 6, y + 6, 5, dot);
-  tft.setCursor(PADDING + 18, y);
-  tft.setTextColor(TFT_WHITE, TFT_BLACK);
-  tft.setTextSize(1);
-  if (receivedOnce) tft.print(fresh ? " " : " ");
-  else tft.print("Waiting for data...");
+#if WIO_ALERTS
+  // A blinking alert alternates the dot between the alert colour and off
+  if (alerts.actions() & ALERT_BLINK) dot = (millis() / ALERT_BLINK_MS) & 1 ? TFT_BLACK : ALERT_COLOR;
+#endif
+  if (lastStatus.dot != dot) {
+    tft.fillCircle(PADDING + 6, y + 6, 5, dot);
+    lastStatus.dot = dot;
+  }
+  char left[sizeof(lastStatus.left)];
+  sourceLabel(left, sizeof(left));
+  drawStatusText(PADDING + 18, y, SCREEN_W - 88 - (PADDING + 18), left, TFT_WHITE,
+                 lastStatus.left, sizeof(lastStatus.left));
 
-  // Show Bluetooth availability on the right
-  tft.setCursor(SCREEN_W - 88, y);
-  tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-  tft.print(BT_AVAILABLE ? "" : "x");
-  tft.setTextColor(TFT_WHITE, TFT_BLACK);
+  // Show Bluetooth availability on the right, "BT.." while the radio comes up
+  drawStatusText(SCREEN_W - 88, y, 88 - PADDING, !BT_AVAILABLE ? "x" : (bleUp() ? "" : "BT.."), TFT_YELLOW,
+                 lastStatus.right, sizeof(lastStatus.right));
 }
 
-// Forward declaration so helpers can call it before its definition
-void updateBarsAndTemps(const Metrics &m);
-
 // Reset cached draw state so next update paints fresh after a clear()
 static inline void resetDrawCaches() {
-  lastCpuW = -1;
-  lastRamW = -1;
-  lastGpuW = -1;
-  lastDrawn.cpu = -1000;
-  lastDrawn.ram = -1000;
-  lastDrawn.gpu = -1000;
-  lastDrawn.tempC = -1000;
-  lastDrawn.gpuTempC = -1000;
+  dashboard.invalidate();
+  lastStatus = LastStatus();
+  for (int i = 0; i < SPARK_COUNT; ++i) sparks[i].invalidate();
+}
+
+RenderScheduler renderSched(RENDER_MAX_FPS);
+#if WIO_LATENCY
+// Stamped samples of the shown source waiting for their frame (under SCHED_LOCK)
+LatencyQueue<LATENCY_PENDING> latencyQueue;
+#endif
+
+#if WIO_USE_RTOS
+// Single-slot mailbox for BLE re-broadcast: writers overwrite, the reader sees the latest
+static QueueHandle_t notifyQueue = nullptr;
+#if WIO_LATENCY
+// BLE echoes for the notify task, which fills in their send time
+static QueueHandle_t echoQueue = nullptr;
+#endif
+static TaskHandle_t renderTaskHandle = nullptr;
+static TaskHandle_t notifyTaskHandle = nullptr;
+// renderSched is shared between the ingest and render tasks
+#define SCHED_LOCK() taskENTER_CRITICAL()
+#define SCHED_UNLOCK() taskEXIT_CRITICAL()
+#else
+#define SCHED_LOCK() do {} while (0)
+#define SCHED_UNLOCK() do {} while (0)
+#endif
+
+// Centralized LCD power control helpers. Only the backlight goes off: the panel
+// keeps its contents and the renderer keeps it current (at a lower rate), so
+// waking is a single pin write with nothing to repaint.
+
+// Dark screen: slow clock and repaint rate
+static void setLcdPowerSave(bool save) {
+  power.setSlow(save);
+  dashboard.setAnimate(!save);
+  SCHED_LOCK();
+  renderSched.setMaxFps(save ? LCD_OFF_MAX_FPS : RENDER_MAX_FPS);
+  SCHED_UNLOCK();
 }
 
-// Centralized LCD power control helpers
 static inline void lcdSleep() {
   if (!isLcdOn) return;
-  tft.fillScreen(TFT_BLACK);      // optional: blank the screen
-  // Use backlight control for LCD off
+  STALL_SCOPE(PHASE_WAKE);
   digitalWrite(LCD_BACKLIGHT, LOW);
   isLcdOn = false;
+  setLcdPowerSave(true);
 }
 
 static inline void lcdWake() {
   if (isLcdOn) return;
-  // Use backlight control for LCD on
+  STALL_SCOPE(PHASE_WAKE);
+  setLcdPowerSave(false);
   digitalWrite(LCD_BACKLIGHT, HIGH);
-  delay(5);
-  drawStaticLayoutOnce();
-  resetDrawCaches();
-  updateBarsAndTemps(current);
-  drawStatus();
   isLcdOn = true;
 }
 
-void updateBarsAndTemps(const Metrics &m) {
-  tft.setTextSize(2);
-  // Bars: update only deltas
-  updateBarFill(Y_CPU, m.cpu, TFT_GREEN, lastCpuW);
-  // Temps: update only when changed, with padding
-  int tempTenths = (m.tempC < 0) ? -1 : (int)(m.tempC * 10);
-  if (tempTenths != lastDrawn.tempC) {
-    drawTemp(Y_TEMP, m.tempC);
-    lastDrawn.tempC = tempTenths;
-  }
-  updateBarFill(Y_RAM, m.ram, TFT_CYAN, lastRamW);
-  int gpuInt = (m.gpu < 0) ? -1 : (int)(m.gpu + 0.5f);
-  if (gpuInt != lastDrawn.gpu) {
-    updateBarFill(Y_GPU, m.gpu < 0 ? 0.0f : m.gpu, TFT_ORANGE, lastGpuW);
-    lastDrawn.gpu = gpuInt;
-  }
-  int gpuTempTenths = (m.gpuTempC < 0) ? -1 : (int)(m.gpuTempC * 10);
-  if (gpuTempTenths != lastDrawn.gpuTempC) {
-    // Draw only value, label is static
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.setTextDatum(MR_DATUM);
-    tft.setTextPadding(64);
-    if (m.gpuTempC < 0) tft.drawString("N/A", SCREEN_W - PADDING, Y_GPUTEMP);
-    else {
-      char buf[24];
-      snprintf(buf, sizeof(buf), "%.0fC", m.gpuTempC);
-      tft.drawString(buf, SCREEN_W - PADDING, Y_GPUTEMP);
-    }
-    tft.setTextDatum(TL_DATUM);
-    lastDrawn.gpuTempC = gpuTempTenths;
+// Returns true while the bars are still easing toward `m`
+bool updateBarsAndTemps(const Metrics &m) {
+  // Trends: scroll in whatever history arrived since the last frame
+  if (shownSlot >= 0) {
+    PERF_SCOPE(PERF_SPARKS);
+    for (int i = 0; i < SPARK_COUNT; ++i) sparks[i].update(sources[shownSlot].history);
   }
+  return dashboard.update(m, millis());
 }
 
-void setup() {
-  Serial.begin(115200);
-  #if defined(RPC_BLE_SUPPORTED)
-    // Initialize Seeed rpcBLE (BLE GATT server) with a UART-like service
-    BLEDevice::init("WioMonitor");
-    BLEServer *pServer = BLEDevice::createServer();
-    pServer->setCallbacks(nullptr);
-
-    // UART service UUIDs (commonly used Nordic UART service style)
-    const char* UART_SERVICE = "6E400001-B5A3-F393-E0A9-E50E24DCCA9E";
-    const char* UART_CHAR_RX = "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"; // central -> peripheral (WRITE)
-    const char* UART_CHAR_TX = "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"; // peripheral -> central (NOTIFY)
-
-    // Create service and characteristics
-    BLEService *pService = pServer->createService(UART_SERVICE);
-    BLECharacteristic * pTxCharacteristic = pService->createCharacteristic(
-                                          UART_CHAR_TX,
-                                          BLECharacteristic::PROPERTY_NOTIFY | BLECharacteristic::PROPERTY_READ
-                                        );
-    pTxCharacteristic->setAccessPermissions(GATT_PERM_READ);
-    pTxCharacteristic->addDescriptor(new BLE2902());
-    metricsCharacteristic = pTxCharacteristic; // expose as global for notifications
-
-    BLECharacteristic * pRxCharacteristic = pService->createCharacteristic(
-                                          UART_CHAR_RX,
-                                          BLECharacteristic::PROPERTY_WRITE
-                                        );
-    pRxCharacteristic->setAccessPermissions(GATT_PERM_READ | GATT_PERM_WRITE);
-
-  // Incoming BLE writes will be handled by this callback which stores the last packet
-    class RxCallbacks: public BLECharacteristicCallbacks {
-      void onWrite(BLECharacteristic *c) {
-        std::string v = c->getValue();
-        if (!v.empty()) {
-          // store into static for loop() to consume
-          lastBlePacket = v;
-          haveBlePacket = true;
-        }
+// Radio bring-up, in steps, so the panel and serial ingest are already live
+// while it runs: one step per loop pass, or all of them at the start of the
+// notify task. Until it finishes metricsCharacteristic is null and notifies are
+// dropped.
+// Run the next bring-up step; true once the radio is up
+static bool bleBringUpStep() {
+  if (bleUp()) return true;
+  LOOP_STALL_SCOPE(PHASE_SETUP);
+#if defined(RPC_BLE_SUPPORTED)
+  // UART service UUIDs (commonly used Nordic UART service style)
+  static const char *const UART_SERVICE = "6E400001-B5A3-F393-E0A9-E50E24DCCA9E";
+  static const char *const UART_CHAR_RX = "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"; // central -> peripheral (WRITE)
+  static const char *const UART_CHAR_TX = "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"; // peripheral -> central (NOTIFY)
+  static BLEServer *pServer = nullptr;
+  switch (bleStage) {
+    case BLE_INIT:
+      // Initialize Seeed rpcBLE (BLE GATT server) with a UART-like service
+      BLEDevice::init("WioMonitor");
+      pServer = BLEDevice::createServer();
+      pServer->setCallbacks(nullptr);
+      bleStage = BLE_SERVICE;
+      return false;
+    case BLE_SERVICE: {
+      // Create service and characteristics
+      BLEService *pService = pServer->createService(UART_SERVICE);
+      BLECharacteristic * pTxCharacteristic = pService->createCharacteristic(
+                                            UART_CHAR_TX,
+                                            BLECharacteristic::PROPERTY_NOTIFY | BLECharacteristic::PROPERTY_READ
+                                          );
+      pTxCharacteristic->setAccessPermissions(GATT_PERM_READ);
+      pTxCharacteristic->addDescriptor(new BLE2902());
+      {
+        // Until the first notification, a read of TX returns our capacity (FRAME_CAPS)
+        uint8_t caps[16];
+        pTxCharacteristic->setValue(caps, encodeCapsFrame(caps, sizeof(caps)));
       }
-    };
-  pRxCharacteristic->setCallbacks(new RxCallbacks());
-
-    pService->start();
-    BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
-    pAdvertising->addServiceUUID(UART_SERVICE);
-    pAdvertising->setScanResponse(true);
-    pAdvertising->setMinPreferred(0x06);
-    pAdvertising->setMinPreferred(0x12);
-    BLEDevice::startAdvertising();
-    delay(200);
-  #elif defined(BT_HARDWARE_SUPPORTED)
+
+      BLECharacteristic * pRxCharacteristic = pService->createCharacteristic(
+                                            UART_CHAR_RX,
+                                            BLECharacteristic::PROPERTY_WRITE
+                                          );
+      pRxCharacteristic->setAccessPermissions(GATT_PERM_READ | GATT_PERM_WRITE);
+
+      // Incoming BLE writes are queued whole into the SPSC ring for loop() to consume
+      class RxCallbacks: public BLECharacteristicCallbacks {
+        void onWrite(BLECharacteristic *c) {
+          std::string v = c->getValue();
+          bleRxRing.push((const uint8_t*)v.data(), v.size());
+        }
+      };
+      pRxCharacteristic->setCallbacks(new RxCallbacks());
+
+      pService->start();
+      metricsCharacteristic = pTxCharacteristic; // expose as global for notifications
+      bleStage = BLE_ADVERTISE;
+      return false;
+    }
+    default: {
+      BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
+      pAdvertising->addServiceUUID(UART_SERVICE);
+      pAdvertising->setScanResponse(true);
+      pAdvertising->setMinPreferred(0x06);
+      pAdvertising->setMinPreferred(0x12);
+      BLEDevice::startAdvertising();
+      break;
+    }
+  }
+#elif defined(BT_HARDWARE_SUPPORTED)
   SerialBT.begin("WioMonitor"); // Initialize Bluetooth with device name
-  // Give the radio a moment to become discoverable
-  delay(500);
-  #endif
+#endif
+  bleStage = BLE_UP;
+  bootTimes.bleMs = millis();
+  char buf[48];
+  snprintf(buf, sizeof(buf), "# boot: radio up at %lu ms", (unsigned long)bootTimes.bleMs);
+  Serial.println(buf);
+  return true;
+}
+
+#if WIO_USE_RTOS
+static void startTasks();
+#endif
+static void pumpSerial();
+
+void setup() {
+#if WIO_STALL_MONITOR
+  // First, so a hang anywhere in setup is caught and attributed
+  stallMonitor.begin();
+#endif
+  Serial.begin(SERIAL_BAUD);
   tft.init();
   tft.setRotation(3); // landscape
   tft.fillScreen(TFT_BLACK);
@@ -333,127 +396,1009 @@ void setup() {
   tft.setTextColor(TFT_WHITE, TFT_BLACK);
   tft.setTextDatum(TL_DATUM);
   tft.setSwapBytes(true);
+  dashboard.begin();
+#if !WIO_USE_RTOS
+  // Single loop: keep the CDC endpoint drained while widgets stream out
+  dashboard.setIdleHook(pumpSerial);
+#endif
+  power.begin();
+#if defined(WIO_5S_LEFT) && defined(WIO_5S_RIGHT)
+  pinMode(WIO_5S_LEFT, INPUT_PULLUP);
+  pinMode(WIO_5S_RIGHT, INPUT_PULLUP);
+#endif
+#if defined(WIO_KEY_C)
+  pinMode(WIO_KEY_C, INPUT_PULLUP);
+#endif
+#if WIO_PERF && defined(WIO_KEY_B)
+  pinMode(WIO_KEY_B, INPUT_PULLUP);
+#endif
+  perfBegin();
+#if WIO_TRACE
+  traceStore.begin();
+#endif
+#if WIO_SKIN
+  skin.begin(layoutId());
+#endif
 
   drawStaticLayoutOnce();
+  setupSparklines();
   //tft.drawCentreString("Waiting for data...", SCREEN_W/2, SCREEN_H/2 - 8, 2);
-  // Flush any stale serial input
-  delay(10);
-  while (Serial.available()) (void)Serial.read();
-}
-
-bool parseLine(const String &line, Metrics &out) {
-  // Expect: CPU,TEMP,RAM,GPU,GPUTEMP\n
-  // Split by commas
-  int idx1 = line.indexOf(',');
-  int idx2 = line.indexOf(',', idx1 + 1);
-  int idx3 = line.indexOf(',', idx2 + 1);
-  int idx4 = line.indexOf(',', idx3 + 1);
-  if (idx1 < 0 || idx2 < 0 || idx3 < 0 || idx4 < 0) return false;
-
-  String sCPU = line.substring(0, idx1);
-  String sTemp = line.substring(idx1 + 1, idx2);
-  String sRAM = line.substring(idx2 + 1, idx3);
-  String sGPU = line.substring(idx3 + 1, idx4);
-  String sGPUTemp = line.substring(idx4 + 1);
-
-  out.cpu = sCPU.toFloat();
-  out.tempC = sTemp.toFloat();
-  out.ram = sRAM.toFloat();
-  out.gpu = sGPU.toFloat();
-  out.gpuTempC = sGPUTemp.toFloat();
-  return true;
+  // Serial input is not flushed: the line parser drops a partial first line, and
+  // a sample already waiting is the quickest first frame there is
+  bootTimes.screenMs = millis();
+  {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "# boot: screen at %lu ms", (unsigned long)bootTimes.screenMs);
+    Serial.println(buf);
+  }
+
+#if WIO_STALL_MONITOR
+  if (stallMonitor.resetByWatchdog) Serial.println("# stalls: restarted by the watchdog, see ?stalls");
+  stallMonitor.enter(PHASE_LOOP);
+#endif
+#if WIO_USE_RTOS
+  startTasks();
+#endif
 }
 
 unsigned long lastRender = 0;
 
-void loop() {
-  unsigned long now = millis();
+// Stats overlay: replaces the widget rows with the perf counters while shown
+bool perfOverlay = false;
+const int OVERLAY_Y = ROW_Y0;
+const int OVERLAY_LINE_H = 12;
 
-  // If rpcBLE provided incoming writes, consume them and feed into parser
-#if defined(RPC_BLE_SUPPORTED)
-  if (haveBlePacket) {
-    // Move the data into lineBuf (clip to reasonable length)
-    std::string s = lastBlePacket;
-    if (!s.empty()) {
-      String incoming = String(s.c_str());
-      // Append a newline if missing
-      if (incoming.endsWith("\n") == false) incoming += '\n';
-      // Feed byte-by-byte to the same parser used for Serial
-      for (size_t i = 0; i < incoming.length(); ++i) {
-        char c = incoming.charAt(i);
-        if (c == '\n') {
-          String trimmed = lineBuf;
-          trimmed.trim();
-          Metrics m;
-          if (parseLine(trimmed, m)) {
-            current = m;
-            receivedOnce = true;
-            lastRxMillis = millis();
-            lastLineShown = trimmed;
-            updateBarsAndTemps(current);
-            drawStatus();
-            lcdWake();
-          }
-          lineBuf = "";
-        } else if (c != '\r') {
-          if (lineBuf.length() < 128) lineBuf += c;
-          else lineBuf = "";
-        }
-      }
-    }
-    haveBlePacket = false;
-    lastBlePacket.clear();
-  }
-#endif
-  // Read incoming serial line
-  while (Serial.available()) {
-    char c = (char)Serial.read();
-    if (c == '\n') {
-      String trimmed = lineBuf;
-      trimmed.trim();
-      Metrics m;
-      if (parseLine(trimmed, m)) {
-        current = m;
-        receivedOnce = true;
-        lastRxMillis = millis();
-        lastLineShown = trimmed;
-        updateBarsAndTemps(current);
-        drawStatus();
-        lcdWake();
-
-  // Send data over Bluetooth: either rpcBLE GATT notify or BluetoothSerial
-  String bluetoothData = "CPU:" + String(current.cpu) + ",TEMP:" + String(current.tempC) + ",RAM:" + String(current.ram) + ",GPU:" + String(current.gpu) + ",G-TEMP:" + String(current.gpuTempC);
+static void drawPerfOverlay() {
+  char line[64], mn[12], av[12], p99[12], mx[12];
+  tft.setTextSize(1);
+  tft.setTextColor(TFT_WHITE, TFT_BLACK);
+  tft.setCursor(PADDING, OVERLAY_Y);
+  tft.print("section   count    min    avg    p99    max (us)");
+  for (uint8_t i = 0; i < PERF_SLOT_COUNT; ++i) {
+    const PerfStat &st = perfStats[i];
+    uint32_t perUs = perfCyclesPerUs();
+    snprintf(mn, sizeof(mn), "%lu", (unsigned long)(st.min() / perUs));
+    snprintf(av, sizeof(av), "%lu", (unsigned long)(st.avg() / perUs));
+    snprintf(p99, sizeof(p99), "%lu", (unsigned long)(st.percentile(99) / perUs));
+    snprintf(mx, sizeof(mx), "%lu", (unsigned long)(st.max() / perUs));
+    // Fixed-width lines with a text background overwrite the previous values in place
+    snprintf(line, sizeof(line), "%-7s %7lu %6s %6s %6s %6s", PERF_SLOT_NAMES[i],
+             (unsigned long)st.count(), mn, av, p99, mx);
+    tft.setCursor(PADDING, OVERLAY_Y + (i + 1) * OVERLAY_LINE_H);
+    tft.print(line);
+  }
+  tft.setTextSize(2);
+}
+
+static void showSource(int slot);
+
+static void setPerfOverlay(bool on) {
+  STALL_SCOPE(PHASE_DRAW);
+  perfOverlay = on;
+  tft.fillRect(0, OVERLAY_Y, SCREEN_W, ROW_Y(WIDGET_COUNT) - OVERLAY_Y, TFT_BLACK);
+  if (on) {
+    drawPerfOverlay();
+  } else if (shownSlot >= 0) {
+    showSource(shownSlot);
+  } else {
+    drawRowsBackground();
+    resetDrawCaches();
+  }
+}
+
+#if WIO_SKIN
+// The skin changed under us: repaint the background and everything on it
+static void relayout() {
+  STALL_SCOPE(PHASE_DRAW);
+  drawStaticLayoutOnce();
+  resetDrawCaches();
+  drawStatus();
+  if (perfOverlay) {
+    setPerfOverlay(true);
+    return;
+  }
+  SCHED_LOCK();
+  if (shownSlot >= 0) renderSched.invalidate(sources[shownSlot].metrics);
+  SCHED_UNLOCK();
+}
+#endif
+
+// Draw a frame (display owner only). `fresh` is false for frames that only
+// advance an animation; those must not wake the screen.
+static void renderSample(const Metrics &m, bool fresh) {
+  bool moving = false;
+  if (!perfOverlay) {
+    PERF_SCOPE(PERF_FRAME);
+    STALL_SCOPE(PHASE_DRAW);
+    // Widgets last: their final transfer keeps streaming while the loop moves on
+    drawStatus();
+    moving = updateBarsAndTemps(m);
+  }
+  SCHED_LOCK();
+  renderSched.setAnimating(moving);
+  SCHED_UNLOCK();
+  if (fresh && !lcdOffByUser) lcdWake();
+}
+
+// Last values actually notified, per field, for the deadband comparison
+struct NotifyState {
+  Metrics sent;
+  bool haveSent = false;
+  unsigned long lastKeyframeMs = 0;
+} notifyState;
+
+static void sendNotify(const uint8_t *data, size_t len) {
 #if defined(RPC_BLE_SUPPORTED)
+  LOOP_STALL_SCOPE(PHASE_NOTIFY);
   if (metricsCharacteristic) {
-    // setValue expects std::string or raw bytes; convert
-    std::string s = std::string((const char*)bluetoothData.c_str(), bluetoothData.length());
-    metricsCharacteristic->setValue(s);
+    metricsCharacteristic->setValue((uint8_t *)data, len);
     metricsCharacteristic->notify();
   }
 #elif defined(BT_HARDWARE_SUPPORTED)
-  SerialBT.println(bluetoothData);
+  if (bleUp()) SerialBT.write(data, len);
+#else
+  (void)data; (void)len; // noop stub: nothing
+#endif
+}
+
+// Send a sample over Bluetooth: either rpcBLE GATT notify or BluetoothSerial
+static void notifySample(const Metrics &m) {
+  PERF_SCOPE(PERF_NOTIFY);
+#if BLE_NOTIFY_TEXT
+  static const char *const names[FIELD_LEGACY_COUNT] = { "CPU:", ",TEMP:", ",RAM:", ",GPU:", ",G-TEMP:" };
+  char text[96];
+  char *p = text;
+  for (uint8_t f = 0; f < FIELD_LEGACY_COUNT; ++f) {
+    strcpy(p, names[f]);
+    p = formatTenths(p + strlen(names[f]), m.v[f]);
+  }
+  sendNotify((const uint8_t *)text, (size_t)(p - text));
 #else
-  // noop stub: nothing
+  unsigned long now = millis();
+  bool keyframe = !notifyState.haveSent || (now - notifyState.lastKeyframeMs) >= BLE_NOTIFY_KEYFRAME_MS;
+  uint8_t mask = keyframe ? FIELD_MASK_ALL
+                          : fieldsBeyondDeadband(notifyState.sent, m, BLE_NOTIFY_DEADBAND_TENTHS);
+  if (mask == 0) return; // nothing moved past the deadband: stay off the air
+
+  uint8_t frame[SAMPLE_FRAME_MAX];
+  size_t cap = BLE_NOTIFY_MTU - 3 < sizeof(frame) ? BLE_NOTIFY_MTU - 3 : sizeof(frame);
+  size_t n = encodeSampleFrame(m, mask, frame, cap);
+  if (n == 0) return;
+  sendNotify(frame, n);
+
+  for (uint8_t f = 0; f < FIELD_LEGACY_COUNT; ++f) {
+    if (mask & (1u << f)) notifyState.sent.v[f] = m.v[f];
+  }
+  notifyState.haveSent = true;
+  if (keyframe) notifyState.lastKeyframeMs = now;
+#endif
+}
+
+#if WIO_LATENCY
+// Answer a FRAME_STAMP on the transport it came in on
+static void sendEcho(const LatencySample &s) {
+  uint8_t frame[24];
+  if (s.serial) {
+    Serial.write(frame, encodeEchoFrame(s.report(millis()), frame, sizeof(frame)));
+    return;
+  }
+#if WIO_USE_RTOS
+  if (xQueueSend(echoQueue, &s, 0) == pdTRUE) xTaskNotifyGive(notifyTaskHandle);
+#else
+  sendNotify(frame, encodeEchoFrame(s.report(millis()), frame, sizeof(frame)));
+#endif
+}
+
+// Echo what the frame taken with `covered` samples waiting has just drawn (display owner)
+static void echoDrawn(uint8_t covered) {
+  if (covered == 0) return;
+  LatencySample done[LATENCY_PENDING];
+  uint32_t now = millis();
+  SCHED_LOCK();
+  uint8_t n = latencyQueue.drawn(covered, now, done, perfOverlay ? ECHO_OFFSCREEN : 0);
+  SCHED_UNLOCK();
+  for (uint8_t i = 0; i < n; ++i) sendEcho(done[i]);
+}
+#endif
+
+// Accept one decoded sample from `src`; `rebroadcast` forwards it to BLE subscribers
+// (serial input only). Only the source on screen feeds the renderer.
+static void handleSample(HostSource &src, const Metrics &m, bool rebroadcast) {
+  unsigned long now = millis();
+#if WIO_LATENCY
+  LatencySample stamp;
+  bool stamped = src.rx.stamp.take(now, src.key == SOURCE_SERIAL, stamp);
+  bool queued = false;
+#endif
+  src.metrics = m;
+  src.receivedOnce = true;
+  src.lastRxMillis = now;
+  if (!receivedOnce) {
+    bootTimes.firstSampleMs = now;
+    char buf[48];
+    snprintf(buf, sizeof(buf), "# boot: first sample at %lu ms", now);
+    Serial.println(buf);
+  }
+  receivedOnce = true;
+  lastRxMillis = now;
+  SCHED_LOCK();
+  src.history.push(m); // every sample, even ones the renderer coalesces away
+  if (shownSlot < 0) {
+    shownSlot = (int)(&src - &sources[0]);
+    shownKey = src.key;
+  }
+  bool shown = &sources[shownSlot] == &src;
+  if (shown) {
+    renderSched.submit(m, now);
+#if WIO_LATENCY
+    queued = latencyQueue.submitted(stamped ? &stamp : nullptr) && stamped;
+#endif
+  }
+  SCHED_UNLOCK();
+#if WIO_LATENCY
+  if (stamped && !queued) {
+    stamp.flags |= shown ? ECHO_UNTIMED : ECHO_OFFSCREEN;
+    sendEcho(stamp);
+  }
+#endif
+#if WIO_USE_RTOS
+  if (shown) xTaskNotifyGive(renderTaskHandle);
+  if (rebroadcast) {
+    xQueueOverwrite(notifyQueue, &m);
+    xTaskNotifyGive(notifyTaskHandle);
+  }
+#else
+  if (rebroadcast) notifySample(m);
+#endif
+}
+
+// An older record of a batch: it belongs in the history but is never drawn
+static void recordSample(HostSource &src, const Metrics &m) {
+  src.metrics = m;
+  SCHED_LOCK();
+  src.history.push(m);
+  SCHED_UNLOCK();
+}
+
+#if WIO_USE_RTOS
+// BLE replies are left to the notify task so only one task talks to the radio
+static volatile bool bleCapsPending = false;
+#if RATE_ADVICE_MS > 0
+static volatile bool bleRatePending = false;
+#endif
+#endif
+
+// Advertise our capacity back on the transport the data came from, e.g. when the
+// host sends values for a schema we do not have (rate-limited)
+static void replyCaps(RxStream &rx, bool fromSerial) {
+  unsigned long now = millis();
+  if (rx.lastCapsMs != 0 && now - rx.lastCapsMs < 1000) return;
+  rx.lastCapsMs = now;
+  uint8_t frame[16];
+  size_t n = encodeCapsFrame(frame, sizeof(frame));
+  if (fromSerial) {
+    Serial.write(frame, n);
+    return;
+  }
+#if WIO_USE_RTOS
+  bleCapsPending = true;
+#else
+  sendNotify(frame, n);
+#endif
+}
+
+static void handleFrame(HostSource &src, bool fromSerial) {
+  RxStream &rx = src.rx;
+  const uint8_t *p = rx.frame.payload();
+  size_t len = rx.frame.length();
+  switch (rx.frame.type()) {
+    case FRAME_SAMPLE: {
+      Metrics m = src.metrics;
+      if (decodeSampleFrame(p, len, m)) handleSample(src, m, fromSerial);
+      break;
+    }
+    case FRAME_BATCH: {
+      BatchReader batch;
+      if (!batch.begin(p, len)) break;
+      Metrics m = src.metrics;
+      uint32_t hostMs; // the history is indexed by sample, so times only order them
+      while (batch.next(m, hostMs)) {
+        if (batch.remaining() > 0) recordSample(src, m);
+        else handleSample(src, m, fromSerial);
+      }
+      break;
+    }
+    case FRAME_SCHEMA:
+      applySchemaFrame(rx.schema, p, len);
+      break;
+    case FRAME_VALUES: {
+      if (len >= 2 && p[1] == 0) rx.staged = src.metrics; // first chunk of a sample
+      ValuesResult r = decodeValuesFrame(rx.schema, p, len, rx.staged);
+      if (r == VALUES_COMPLETE) handleSample(src, rx.staged, fromSerial);
+      else if (r == VALUES_UNKNOWN_SCHEMA) replyCaps(rx, fromSerial);
+      break;
+    }
+#if WIO_LATENCY
+    case FRAME_STAMP: {
+      uint16_t seq;
+      uint32_t hostMs;
+      // Replayed probes would be answered to a host that never sent them
+      bool live = !(src.key & SOURCE_REPLAY);
+      if (live && decodeStampFrame(p, len, seq, hostMs)) rx.stamp.arm(seq, hostMs);
+      break;
+    }
 #endif
+    case FRAME_HOST:
+      // Routing happens per BLE write (see pollInputs); mid-stream it only names the source
+      if (len >= 1) src.setName(p + 1, len - 1);
+      break;
+    default:
+      break; // unknown frame types are skipped whole
+  }
+}
+
+#if WIO_TRACE
+// "# trace: recorded ..." summary once a recording has ended, `why` prefixed if given
+static void printRecorded(unsigned long now, const char *why) {
+  char buf[112];
+  snprintf(buf, sizeof(buf), "# trace: %srecorded %lu records (%lu bytes, %lu dropped) in %lu ms", why,
+           (unsigned long)traceStore.records, (unsigned long)traceStore.bytes,
+           (unsigned long)traceStore.dropped, now - traceStore.startMs);
+  Serial.println(buf);
+}
+
+// "?trace rec" / "?trace stop" / "?trace play" (1x) / "?trace play max" / "?trace play <hz>"
+static void traceCommand(const char *arg) {
+  LOOP_STALL_SCOPE(PHASE_FLASH);
+  while (*arg == ' ') arg++;
+  unsigned long now = millis();
+  char buf[96];
+  if (!traceStore.available()) {
+    Serial.println("# trace: no flash file system");
+  } else if (strcmp(arg, "rec") == 0) {
+    Serial.println(traceStore.startRecording(now) ? "# trace: recording" : "# trace: busy");
+  } else if (strcmp(arg, "stop") == 0) {
+    if (traceStore.recording()) {
+      traceStore.stopRecording();
+      printRecorded(now, "");
+    } else {
+      traceStore.stopReplay();
+      Serial.println("# trace: stopped");
+    }
+  } else if (strncmp(arg, "play", 4) == 0) {
+    const char *how = arg + 4;
+    while (*how == ' ') how++;
+    TraceStore::Pace pace = TraceStore::PACE_REALTIME;
+    uint16_t hz = 0;
+    if (strcmp(how, "max") == 0) {
+      pace = TraceStore::PACE_MAX;
+    } else if (*how >= '1' && *how <= '9') {
+      pace = TraceStore::PACE_FIXED;
+      hz = (uint16_t)atoi(how);
+    }
+    if (traceStore.startReplay(pace, hz, now)) {
+      // Start clean of whatever an earlier replay left half parsed
+      for (int i = 0; i < sources.capacity(); ++i) {
+        if (sources[i].used && (sources[i].key & SOURCE_REPLAY)) sources[i].rx.reset();
       }
-      lineBuf = "";
-    } else if (c != '\r') {
-      // guard against runaway buffer
-      if (lineBuf.length() < 128) lineBuf += c;
-      else lineBuf = "";
+      Serial.println("# trace: replaying");
+    } else {
+      Serial.println("# trace: no trace or busy");
+    }
+  } else {
+    Serial.println("# trace: rec | stop | play [max|<hz>]");
+  }
+}
+#endif
+
+#if WIO_SKIN
+// "?skin" (what is in use) / "?skin put <bytes>" (raw image follows) / "?skin reset"
+static void skinCommand(const char *arg) {
+  LOOP_STALL_SCOPE(PHASE_FLASH);
+  while (*arg == ' ') arg++;
+  char buf[64];
+  if (*arg == '\0') {
+    if (skin.ready()) {
+      snprintf(buf, sizeof(buf), "# skin: %s, %lu bytes", skin.custom() ? "custom" : "built-in",
+               (unsigned long)skin.size());
+      Serial.println(buf);
+    } else {
+      Serial.println("# skin: none (drawn)");
+    }
+  } else if (strncmp(arg, "put ", 4) == 0) {
+    unsigned long bytes = strtoul(arg + 4, nullptr, 10);
+    if (skin.startUpload(bytes, millis())) {
+      snprintf(buf, sizeof(buf), "# skin: send %lu bytes", bytes);
+      Serial.println(buf);
+    } else {
+      Serial.println("# skin: cannot upload");
     }
+  } else if (strcmp(arg, "reset") == 0) {
+    skin.remove();
+    Serial.println("# skin: reset to built-in");
+  } else {
+    Serial.println("# skin: [put <bytes> | reset]");
   }
+}
 
-  // LCD sleep check
+// Upload bytes after "?skin put"; returns how many of `n` were image data
+static size_t skinReceive(const uint8_t *data, size_t n) {
+  LOOP_STALL_SCOPE(PHASE_FLASH);
+  size_t taken = skin.receive(data, n, millis());
+  if (!skin.uploading()) Serial.println(skin.uploaded() ? "# skin: loaded" : "# skin: rejected");
+  return taken;
+}
+#endif
+
+// "?"-prefixed Serial lines are commands; replies are "#" lines
+static void handleCommand(const char *cmd) {
+  if (strcmp(cmd, "?perf") == 0) {
+    perfDump(Serial);
+  } else if (strcmp(cmd, "?perf reset") == 0) {
+    perfReset();
+    Serial.println("# perf: reset");
+#if WIO_STALL_MONITOR
+  } else if (strcmp(cmd, "?stalls") == 0) {
+    stallMonitor.dump(Serial);
+  } else if (strcmp(cmd, "?stalls clear") == 0) {
+    stallMonitor.clear();
+    Serial.println("# stalls: cleared");
+#endif
+#if WIO_TRACE
+  } else if (strncmp(cmd, "?trace", 6) == 0) {
+    traceCommand(cmd + 6);
+#endif
+#if WIO_SKIN
+  } else if (strncmp(cmd, "?skin", 5) == 0) {
+    skinCommand(cmd + 5);
+#endif
+  } else {
+    Serial.println("# commands: ?perf, ?perf reset"
+#if WIO_STALL_MONITOR
+                   ", ?stalls, ?stalls clear"
+#endif
+#if WIO_TRACE
+                   ", ?trace rec|stop|play [max|<hz>]"
+#endif
+#if WIO_SKIN
+                   ", ?skin [put <bytes>|reset]"
+#endif
+                   );
+  }
+}
+
+// Feed one received byte. A sync byte at the start of a line switches to the binary
+// frame decoder until that frame completes; everything else is the CSV line format.
+// One byte of a "?" command line on `rx`; runs the command at its line end
+static void commandByte(RxStream &rx, uint8_t c) {
+  if (c == '\n' || c == '\r') {
+    rx.cmd[rx.cmdLen] = '\0';
+    rx.cmdLen = 0;
+    rx.cmdCr = c == '\r';
+    handleCommand(rx.cmd);
+  } else if (rx.cmdLen < sizeof(rx.cmd) - 1) {
+    rx.cmd[rx.cmdLen++] = (char)c;
+  }
+}
+
+static void feedByte(HostSource &src, uint8_t c, bool fromSerial) {
+  RxStream &rx = src.rx;
+  RxStream::Route route = rx.route(c, fromSerial);
+  if (route == RxStream::ROUTE_COMMAND) {
+    commandByte(rx, c);
+    return;
+  }
+  if (route == RxStream::ROUTE_FRAME) {
+    if (rx.frame.feed(c) == FrameDecoder::FRAME_OK) handleFrame(src, fromSerial);
+    return;
+  }
+  if (rx.line.feed((char)c) == LineParser::LINE_OK) {
+    Metrics m = src.metrics;
+    rx.line.apply(m);
+    handleSample(src, m, fromSerial);
+  }
+}
+
+// Route one BLE write to its host's parsers. Each write is taken whole: a leading
+// FRAME_HOST names its host, else it belongs to host 0. Replayed writes go to that
+// host's replay source instead.
+static void ingestBlePacket(const uint8_t *pkt, size_t n, bool replay) {
+  PERF_SCOPE(PERF_PARSE);
+  uint8_t hostId = 0;
+  const uint8_t *name = nullptr;
+  size_t nameLen = 0;
+  size_t off = parseHostPrefix(pkt, n, hostId, name, nameLen);
+  HostSource &src = sources[sources.acquire(replay ? SOURCE_REPLAY | hostId : hostId, millis())];
+  if (nameLen > 0) src.setName(name, nameLen);
+  if (off == n) return;
+  // Feed the raw bytes: binary frames may contain NULs
+  for (size_t i = off; i < n; ++i) feedByte(src, pkt[i], false);
+  // Treat a BLE write as a complete line if the sender omitted the newline
+  if (!src.rx.frame.active() && pkt[n - 1] != '\n') feedByte(src, '\n', false);
+}
+
+// Serial bytes to the serial source; `live` is false for replayed input, which goes
+// to a source of its own and must not run commands or answer the (absent) host.
+// A terminal that only types commands never claims a host slot: until the first
+// data byte, commands and blank lines are taken by serialConsole instead.
+static RxStream serialConsole;
+
+static void ingestSerial(const uint8_t *data, size_t n, bool live) {
+  PERF_SCOPE(PERF_PARSE);
+  uint16_t key = live ? SOURCE_SERIAL : SOURCE_REPLAY | SOURCE_SERIAL;
+  int slot = live ? sources.find(key) : sources.acquire(key, millis());
+  for (size_t i = 0; i < n; ++i) {
+    uint8_t c = data[i];
+    RxStream &rx = slot >= 0 ? sources[slot].rx : serialConsole;
+    if (rx.cmdCr) {
+      // The '\n' of a CRLF-terminated command, not the image or the next line
+      rx.cmdCr = false;
+      if (c == '\n') continue;
+    }
+#if WIO_SKIN
+    // Bytes after "?skin put" are the image, not input
+    if (live && skin.uploading()) {
+      i += skinReceive(data + i, n - i) - 1;
+      continue;
+    }
+#endif
+    if (slot < 0) {
+      if (serialConsole.route(c, true) == RxStream::ROUTE_COMMAND) {
+        commandByte(serialConsole, c);
+        continue;
+      }
+      if (c == '\n' || c == '\r') continue;
+      slot = sources.acquire(key, millis());
+    }
+    feedByte(sources[slot], c, live);
+  }
+}
+
+#if WIO_TRACE
+// Feed whatever the trace player has due, after flushing any recording
+static void serviceTrace() {
+  static uint8_t record[TraceStore::MAX_RECORD];
+  {
+    LOOP_STALL_SCOPE(PHASE_FLASH);
+    traceStore.service();
+  }
+  TraceStore::Source from;
+  size_t n;
+  for (int i = 0; i < TRACE_REPLAY_BURST && (n = traceStore.nextDue(millis(), from, record, sizeof(record))) > 0; ++i) {
+    if (from == TraceStore::TRACE_BLE) ingestBlePacket(record, n, true);
+    else ingestSerial(record, n, false);
+  }
+  if (traceStore.takeRecordingEnded()) printRecorded(millis(), "size cap reached, ");
+  if (traceStore.takeReplayEnded()) {
+    unsigned long ms = millis() - traceStore.startMs;
+    char buf[80];
+    snprintf(buf, sizeof(buf), "# trace: replayed %lu records (%lu bytes) in %lu ms",
+             (unsigned long)traceStore.records, (unsigned long)traceStore.bytes, ms);
+    Serial.println(buf);
+  }
+}
+#endif
+
+// Move whatever the USB CDC endpoint holds into serialRxRing with bulk reads.
+// Only as much as fits is read: the rest stays in the endpoint, which NAKs the
+// host until there is room, so nothing is lost while the parsers catch up.
+// Called from the input side only (the ingest task in RTOS mode).
+static void pumpSerial() {
+  uint8_t chunk[64];
+  for (;;) {
+    size_t n = (size_t)Serial.available();
+    if (n == 0) return;
+    size_t room = serialRxRing.space();
+    if (room == 0) return;
+    if (n > room) n = room;
+    if (n > sizeof(chunk)) n = sizeof(chunk);
+    n = Serial.readBytes((char *)chunk, n);
+    if (n == 0) return;
+    serialRxRing.push(chunk, n);
+  }
+}
+
+// Drain every pending input (BLE ring and Serial) through the owning source's parsers
+static void pollInputs() {
+  LOOP_STALL_SCOPE(PHASE_PARSE);
+#if defined(RPC_BLE_SUPPORTED)
+  static uint8_t blePacket[512];
+  size_t n;
+  while ((n = bleRxRing.pop(blePacket, sizeof(blePacket))) > 0) {
+    if (traceStore.recording()) traceStore.record(TraceStore::TRACE_BLE, blePacket, n, millis());
+    ingestBlePacket(blePacket, n, false);
+  }
+#endif
+  pumpSerial();
+  static uint8_t chunk[128];
+  size_t len;
+  while ((len = serialRxRing.pop(chunk, sizeof(chunk))) > 0) {
+    if (traceStore.recording()) traceStore.record(TraceStore::TRACE_SERIAL, chunk, len, millis());
+    ingestSerial(chunk, len, true);
+    pumpSerial();
+  }
+#if WIO_TRACE
+  serviceTrace();
+#endif
+#if WIO_SKIN
+  if (skin.service(millis())) Serial.println("# skin: upload timed out");
+#endif
+}
+
+// Put source `slot` on screen: repaint the widget slots and queue its latest sample
+static void showSource(int slot) {
+  STALL_SCOPE(PHASE_DRAW);
+#if WIO_LATENCY
+  unsigned long now = millis();
+  // What the old source still had waiting will never be drawn
+  LatencySample dropped[LATENCY_PENDING];
+  uint8_t nDropped;
+#endif
+  SCHED_LOCK();
+#if WIO_LATENCY
+  nDropped = latencyQueue.drawn(latencyQueue.size(), now, dropped, ECHO_OFFSCREEN);
+#endif
+  shownSlot = slot;
+  shownKey = sources[slot].key;
+  renderSched.invalidate(sources[slot].metrics);
+  SCHED_UNLOCK();
+#if WIO_LATENCY
+  for (uint8_t i = 0; i < nDropped; ++i) sendEcho(dropped[i]);
+#endif
+  tft.setTextSize(2);
+  drawRowsBackground();
+  resetDrawCaches();
+  drawStatus();
+}
+
+#if defined(WIO_5S_LEFT) && defined(WIO_5S_RIGHT)
+// Left/right on the 5-way switch pages through hosts; returns -1, +1 or 0 on a press edge
+static int pageButton() {
+  static bool wasDown = false;
+  int dir = digitalRead(WIO_5S_LEFT) == LOW ? -1 : (digitalRead(WIO_5S_RIGHT) == LOW ? 1 : 0);
+  bool down = dir != 0;
+  bool pressed = down && !wasDown;
+  wasDown = down;
+  return pressed ? dir : 0;
+}
+#else
+static int pageButton() { return 0; }
+#endif
+
+#if defined(WIO_KEY_C)
+// The leftmost top key toggles the screen; true on a press edge
+static bool screenButton() {
+  static bool wasDown = false;
+  bool down = digitalRead(WIO_KEY_C) == LOW;
+  bool pressed = down && !wasDown;
+  wasDown = down;
+  return pressed;
+}
+#else
+static bool screenButton() { return false; }
+#endif
+
+#if WIO_PERF && defined(WIO_KEY_B)
+// The middle top key toggles the stats overlay; true on a press edge
+static bool overlayButton() {
+  static bool wasDown = false;
+  bool down = digitalRead(WIO_KEY_B) == LOW;
+  bool pressed = down && !wasDown;
+  wasDown = down;
+  return pressed;
+}
+#else
+static bool overlayButton() { return false; }
+#endif
+
+#if RATE_ADVICE_MS > 0
+RateAdvisor rateAdvisor(RATE_MIN_INTERVAL_MS, RATE_MAX_INTERVAL_MS);
+
+// Tell hosts how fast to send: on BLE TX, and on Serial once a serial host has sent a sample
+static void sendRateAdvice(const RateAdvice &a) {
+  uint8_t frame[16];
+  size_t n = encodeRateFrame(a, frame, sizeof(frame));
+  // Only to a serial host that sends samples, not into a terminal typing commands
+  int serial = sources.find(SOURCE_SERIAL);
+  if (serial >= 0 && sources[serial].receivedOnce) Serial.write(frame, n);
+#if WIO_USE_RTOS
+  bleRatePending = true;
+#else
+  sendNotify(frame, n);
+#endif
+}
+
+// Re-evaluate pacing once per window (display owner only)
+static void serviceRateAdvice(unsigned long now) {
+  static unsigned long lastEvalMs = 0, lastSentMs = 0;
+  if (now - lastEvalMs < RATE_ADVICE_MS) return;
+  RateInputs in;
+  // Only a screen the user switched off asks hosts to pause. After the idle timeout
+  // nobody is sending anyway, and a paused host could never wake it again.
+  in.lcdOn = !lcdOffByUser;
+  SCHED_LOCK();
+  in.samples = renderSched.samples;
+  in.dropped = renderSched.dropped;
+  SCHED_UNLOCK();
+  in.linkErrors = 0;
+  for (int i = 0; i < sources.capacity(); ++i) in.linkErrors += sources[i].rx.frame.crcErrors;
+#if defined(RPC_BLE_SUPPORTED)
+  in.linkErrors += bleRxRing.overruns.load(std::memory_order_relaxed);
+#endif
+  bool changed = rateAdvisor.update(in, now - lastEvalMs);
+  lastEvalMs = now;
+  if (changed || (rateAdvisor.restricting() && now - lastSentMs >= RATE_RESEND_MS)) {
+    sendRateAdvice(rateAdvisor.advice());
+    lastSentMs = now;
+  }
+}
+#endif
+
+// Page switching (display owner only): buttons, auto-rotation, and a slot being reused
+static void servicePages(unsigned long now) {
+  if (shownSlot < 0 || !isLcdOn || perfOverlay) return;
+  int dir = pageButton();
+#if HOST_PAGE_MS > 0
+  static unsigned long lastPageMs = 0;
+  if (dir == 0 && now - lastPageMs >= HOST_PAGE_MS) dir = 1;
+  if (dir != 0) lastPageMs = now;
+#else
+  (void)now;
+#endif
+  int target = shownSlot;
+  if (dir != 0) {
+    int next = sources.nextPage(shownSlot, dir);
+    if (next >= 0) target = next;
+  }
+  if (target != shownSlot || sources[shownSlot].key != shownKey) showSource(target);
+}
+
+#if WIO_ALERTS
+// Run the alert rules over what the shown source sent since the last pass and
+// apply what changed: widget colours, "# alert:" lines, the dot blink, the buzzer.
+// takeChanges() bounds how often any of it redraws.
+static void serviceAlerts(uint32_t now) {
+  if (shownSlot < 0) return;
+  alerts.update(sources[shownSlot].history, now);
+  uint8_t changed = alerts.takeChanges(now);
+  for (int r = 0; r < ALERT_COUNT; ++r) {
+    if (!(changed & (1u << r))) continue;
+    const AlertRule &rule = ALERT_RULES[r];
+    char buf[40];
+    snprintf(buf, sizeof(buf), "# alert: %s %s", rule.name, alerts.shown(r) ? "on" : "off");
+    Serial.println(buf);
+    if (!(rule.actions & ALERT_RECOLOR)) continue;
+    for (int i = 0; i < WIDGET_COUNT; ++i) {
+      const WidgetDesc &d = WIDGETS[i];
+      if (d.field != rule.field) continue;
+      uint16_t color = alerts.shown(r) ? ALERT_COLOR : d.color;
+      if (d.kind == WIDGET_BAR) dashboard.setColor(i, color);
+      if (d.spark >= 0) sparks[d.spark].setColor(color);
+    }
+  }
+  if (changed) {
+    // Repaint in the new colours
+    SCHED_LOCK();
+    renderSched.invalidate(sources[shownSlot].metrics);
+    SCHED_UNLOCK();
+  }
+  // The dot only needs drawing when its blink phase flips
+  static uint8_t lastPhase = 0;
+  uint8_t phase = (alerts.actions() & ALERT_BLINK) ? (uint8_t)(1 + ((now / ALERT_BLINK_MS) & 1)) : 0;
+  if (phase != lastPhase) {
+    lastPhase = phase;
+    drawStatus();
+  }
+#if ALERT_BUZZER && defined(WIO_BUZZER)
+  static uint32_t lastBeepMs = 0;
+  if ((alerts.actions() & ALERT_BUZZ) && now - lastBeepMs >= ALERT_BEEP_EVERY_MS) {
+    tone(WIO_BUZZER, ALERT_BEEP_HZ, ALERT_BEEP_MS);
+    lastBeepMs = now;
+  }
+#endif
+}
+#endif
+
+// Display housekeeping: draw the latest sample when a frame is due, LCD sleep, status refresh
+static void serviceDisplay() {
+  // Anything below may draw; the frame is rendered last so its DMA overlaps
+  // the next input poll
+  dashboard.settle();
+  unsigned long now = millis();
+  servicePages(now);
+#if WIO_SKIN
+  if (skin.takeChanged()) relayout();
+#endif
+
+#if RENDER_STATS_LOG_MS > 0
+  static unsigned long lastStatsLog = 0;
+  if (now - lastStatsLog >= RENDER_STATS_LOG_MS) {
+    char buf[160];
+    snprintf(buf, sizeof(buf), "# render: samples=%lu frames=%lu anim=%lu redraws=%lu dropped=%lu coalesced=%lu maxLatencyMs=%lu",
+             (unsigned long)renderSched.samples, (unsigned long)renderSched.frames,
+             (unsigned long)renderSched.animFrames, (unsigned long)renderSched.redraws,
+             (unsigned long)renderSched.dropped, (unsigned long)renderSched.coalesced,
+             (unsigned long)renderSched.maxLatencyMs);
+    Serial.println(buf);
+    lastStatsLog = now;
+  }
+#endif
+
+  // Screen button: off stays off until pressed again, whatever arrives meanwhile
   now = millis();
-  if (isLcdOn && (now - lastRxMillis) > LCD_SLEEP_TIMEOUT_MS) {
+  if (screenButton()) {
+    lastUserMillis = now;
+    lcdOffByUser = isLcdOn;
+    if (lcdOffByUser) lcdSleep();
+    else lcdWake();
+  }
+
+  if (overlayButton()) {
+    lastUserMillis = now;
+    setPerfOverlay(!perfOverlay);
+  }
+
+  // LCD sleep check
+  unsigned long lastActivity = (long)(lastUserMillis - lastRxMillis) > 0 ? lastUserMillis : lastRxMillis;
+  if (isLcdOn && (now - lastActivity) > LCD_SLEEP_TIMEOUT_MS) {
     lcdSleep();
   }
 
+#if RATE_ADVICE_MS > 0
+  serviceRateAdvice(now);
+#endif
+#if WIO_ALERTS
+  serviceAlerts(millis());
+#endif
+
   // Optionally redraw periodically even without new data
   now = millis();
   if (now - lastRender > 1000) {
     drawStatus();
+    if (perfOverlay) drawPerfOverlay();
     lastRender = now;
   }
+
+  now = millis();
+  SCHED_LOCK();
+  bool due = renderSched.due(now);
+  bool fresh = renderSched.fresh();
+  Metrics m;
+  uint8_t covered = 0;
+  if (due) {
+    m = renderSched.take(now);
+#if WIO_LATENCY
+    covered = latencyQueue.size();
+#endif
+  }
+  SCHED_UNLOCK();
+  if (!due) return;
+  renderSample(m, fresh);
+#if WIO_LATENCY
+  // Timed when the CPU is done with the frame; its last DMA transfer may still be going
+  echoDrawn(covered);
+#else
+  (void)covered;
+#endif
+}
+
+#if WIO_USE_RTOS
+static void ingestTask(void *) {
+  for (;;) {
+#if WIO_STALL_MONITOR
+    stallMonitor.alive(1, millis());
+#endif
+    pollInputs();
+    vTaskDelay(1);
+  }
+}
+
+// Sole owner of `tft` in task mode
+static void renderTask(void *) {
+  for (;;) {
+    // Sleep until the next frame slot if a sample is pending, else until a sample
+    // arrives (or at most 250 ms for status/sleep handling)
+    SCHED_LOCK();
+    uint32_t wait = renderSched.msUntilDue(millis());
+    SCHED_UNLOCK();
+    if (wait > 250) wait = 250;
+#if WIO_ALERTS
+    // Wake in time for the next blink of the status dot
+    if (alerts.actions() & ALERT_BLINK) {
+      uint32_t toBlink = ALERT_BLINK_MS - millis() % ALERT_BLINK_MS;
+      if (wait > toBlink) wait = toBlink;
+    }
+#endif
+    if (wait > 0) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+#if WIO_STALL_MONITOR
+    stallMonitor.beginPass(millis());
+#endif
+    serviceDisplay();
+#if WIO_STALL_MONITOR
+    stallMonitor.endPass(millis());
+#endif
+  }
+}
+
+static void notifyTask(void *) {
+  // The radio comes up here, behind the panel and serial ingest
+  while (!bleBringUpStep()) {
+#if WIO_STALL_MONITOR
+    stallMonitor.alive(2, millis());
+#endif
+  }
+  Metrics m;
+  for (;;) {
+#if WIO_STALL_MONITOR
+    stallMonitor.alive(2, millis());
+#endif
+    // Woken for a sample or an echo; the timeout keeps the other replies going
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    if (xQueueReceive(notifyQueue, &m, 0) == pdTRUE) notifySample(m);
+#if WIO_LATENCY
+    LatencySample echo;
+    while (xQueueReceive(echoQueue, &echo, 0) == pdTRUE) {
+      uint8_t frame[24];
+      sendNotify(frame, encodeEchoFrame(echo.report(millis()), frame, sizeof(frame)));
+    }
+#endif
+    if (bleCapsPending) {
+      bleCapsPending = false;
+      uint8_t frame[16];
+      sendNotify(frame, encodeCapsFrame(frame, sizeof(frame)));
+    }
+#if RATE_ADVICE_MS > 0
+    if (bleRatePending) {
+      bleRatePending = false;
+      uint8_t frame[16];
+      sendNotify(frame, encodeRateFrame(rateAdvisor.advice(), frame, sizeof(frame)));
+    }
+#endif
+  }
+}
+
+static void startTasks() {
+  notifyQueue = xQueueCreate(1, sizeof(Metrics));
+#if WIO_LATENCY
+  echoQueue = xQueueCreate(LATENCY_ECHO_QUEUE, sizeof(LatencySample));
+#endif
+#if WIO_STALL_MONITOR
+  // The watchdog is fed only while render, ingest and notify all keep checking in
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < 3; ++i) stallMonitor.alive(i, now);
+  stallMonitor.expectTasks(3);
+#endif
+  xTaskCreate(renderTask, "render", RENDER_TASK_STACK, nullptr, RENDER_TASK_PRIO, &renderTaskHandle);
+  xTaskCreate(ingestTask, "ingest", INGEST_TASK_STACK, nullptr, INGEST_TASK_PRIO, nullptr);
+  xTaskCreate(notifyTask, "notify", NOTIFY_TASK_STACK, nullptr, NOTIFY_TASK_PRIO, &notifyTaskHandle);
+  vTaskStartScheduler(); // does not return
+}
+#endif
+
+// Sleep the core until the next interrupt unless input or a frame is already waiting.
+// SysTick wakes it every millisecond, so nothing scheduled is ever late by more.
+static void idleUntilEvent() {
+  if (Serial.available() || !serialRxRing.empty()) return;
+#if defined(RPC_BLE_SUPPORTED)
+  if (!bleRxRing.empty()) return;
+#endif
+  if (renderSched.msUntilDue(millis()) == 0) return;
+  power.idle();
+}
+
+void loop() {
+  {
+    PERF_SCOPE(PERF_LOOP);
+#if WIO_STALL_MONITOR
+    stallMonitor.beginPass(millis());
+#endif
+    pollInputs();
+    serviceDisplay();
+    // One radio bring-up step per pass until it is up
+    bleBringUpStep();
+#if WIO_STALL_MONITOR
+    stallMonitor.endPass(millis());
+#endif
+  }
+  idleUntilEvent();
 }
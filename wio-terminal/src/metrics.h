@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+
+// Metric slots (field IDs). The first FIELD_LEGACY_COUNT are the classic five, in
+// wire order of the CSV line and FRAME_SAMPLE; the rest are only reachable through
+// the schema protocol (FRAME_SCHEMA / FRAME_VALUES).
+enum MetricField : uint8_t {
+  FIELD_CPU = 0,
+  FIELD_TEMP,
+  FIELD_RAM,
+  FIELD_GPU,
+  FIELD_GPUTEMP,
+  FIELD_LEGACY_COUNT,
+
+  FIELD_CORE0 = 8,          // per-core CPU load %, tenths
+  FIELD_CORE_MAX = 32,
+  FIELD_GPU_LOAD0 = FIELD_CORE0 + FIELD_CORE_MAX,  // additional GPUs: load %, tenths
+  FIELD_GPU_TEMP0 = FIELD_GPU_LOAD0 + 4,           // additional GPUs: temp C, tenths
+  FIELD_FAN0 = FIELD_GPU_TEMP0 + 4,                // fan speed, whole RPM
+  FIELD_FAN_MAX = 8,
+  FIELD_NET_RX = FIELD_FAN0 + FIELD_FAN_MAX,       // throughput, tenths of MB/s
+  FIELD_NET_TX,
+  FIELD_DISK_READ,
+  FIELD_DISK_WRITE,
+  FIELD_COUNT = 64
+};
+static_assert(FIELD_DISK_WRITE < FIELD_COUNT, "field ID table overflows Metrics");
+
+// One sample of PC metrics as received from the sender, indexed by MetricField.
+// Values are fixed-point tenths (421 => 42.1) from parse through draw unless the
+// field says otherwise; a negative value means N/A.
+struct Metrics {
+  Metrics() {
+    for (int i = 0; i < FIELD_COUNT; ++i) v[i] = -10;
+    v[FIELD_CPU] = 0;
+    v[FIELD_RAM] = 0;
+    v[FIELD_GPUTEMP] = 0;
+  }
+  int16_t v[FIELD_COUNT];
+};
+
+// Integer formatting for display/notify text, so printf float support is not needed.
+// Both write a NUL-terminated string and return a pointer to the terminator.
+
+// Unsigned decimal
+static inline char *formatUint(char *out, uint32_t v) {
+  char tmp[10];
+  int n = 0;
+  do { tmp[n++] = (char)('0' + v % 10); v /= 10; } while (v);
+  while (n) *out++ = tmp[--n];
+  *out = '\0';
+  return out;
+}
+
+// Tenths rounded half-up to a whole number ("42" for 421 and 415)
+static inline char *formatWhole(char *out, int32_t tenths) {
+  if (tenths < 0) { *out++ = '-'; tenths = -tenths; }
+  return formatUint(out, (uint32_t)(tenths + 5) / 10);
+}
+
+// Tenths with one decimal ("42.1", "-1.0")
+static inline char *formatTenths(char *out, int32_t tenths) {
+  if (tenths < 0) { *out++ = '-'; tenths = -tenths; }
+  out = formatUint(out, (uint32_t)tenths / 10);
+  *out++ = '.';
+  *out++ = (char)('0' + tenths % 10);
+  *out = '\0';
+  return out;
+}
@@ -0,0 +1,101 @@
+#include "perf_counters.h"
+#include <Arduino.h>
+
+const char *const PERF_SLOT_NAMES[PERF_SLOT_COUNT] = {
+  "parse", "bar", "value", "sparks", "status", "notify", "frame", "loop",
+};
+
+PerfStat perfStats[PERF_SLOT_COUNT];
+uint8_t perfClockDiv = 1;
+
+void PerfStat::record(uint32_t cycles) {
+  n++;
+  sum += cycles;
+  if (cycles < lo) lo = cycles;
+  if (cycles > hi) hi = cycles;
+  uint16_t &b = hist[bucketOf(cycles)];
+  if (b == UINT16_MAX) {
+    for (uint8_t i = 0; i < BUCKETS; ++i) hist[i] >>= 1;
+  }
+  b++;
+}
+
+void PerfStat::reset() {
+  *this = PerfStat();
+}
+
+uint32_t PerfStat::percentile(uint8_t pct) const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < BUCKETS; ++i) total += hist[i];
+  if (total == 0) return 0;
+  uint32_t want = (uint32_t)(((uint64_t)total * pct + 99) / 100);
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < BUCKETS; ++i) {
+    seen += hist[i];
+    if (seen >= want) {
+      uint32_t top = bucketTop(i);
+      return top < hi ? top : hi;
+    }
+  }
+  return hi;
+}
+
+// Values 0..3 get a bucket each; above that, 4 buckets per power of two
+uint8_t PerfStat::bucketOf(uint32_t cycles) {
+  if (cycles < 4) return (uint8_t)cycles;
+  uint8_t msb = 31 - __builtin_clz(cycles);
+  return (uint8_t)((msb - 1) * 4 + ((cycles >> (msb - 2)) & 3));
+}
+
+uint32_t PerfStat::bucketTop(uint8_t b) {
+  if (b < 4) return b;
+  uint8_t msb = b / 4 + 1;
+  uint32_t step = 1u << (msb - 2);
+  return (4 + b % 4) * step + step - 1;
+}
+
+#if defined(__SAMD51__)
+
+void perfBegin() {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t perfNow() { return DWT->CYCCNT; }
+uint32_t perfCyclesPerUs() { return F_CPU / 1000000UL; }
+void perfSetClockDiv(uint8_t div) { perfClockDiv = div ? div : 1; }
+
+#else
+
+void perfBegin() {}
+uint32_t perfNow() { return micros(); }
+uint32_t perfCyclesPerUs() { return 1; }
+void perfSetClockDiv(uint8_t) {}
+
+#endif
+
+void perfReset() {
+  for (uint8_t i = 0; i < PERF_SLOT_COUNT; ++i) perfStats[i].reset();
+}
+
+// Microseconds with one decimal
+static void formatUs(char *buf, size_t cap, uint32_t cycles) {
+  uint32_t tenths = (uint32_t)((uint64_t)cycles * 10 / perfCyclesPerUs());
+  snprintf(buf, cap, "%lu.%lu", (unsigned long)(tenths / 10), (unsigned long)(tenths % 10));
+}
+
+void perfDump(Print &out) {
+  out.println("# perf: section count min/avg/p99/max us");
+  for (uint8_t i = 0; i < PERF_SLOT_COUNT; ++i) {
+    const PerfStat &s = perfStats[i];
+    char mn[12], av[12], p99[12], mx[12], line[80];
+    formatUs(mn, sizeof(mn), s.min());
+    formatUs(av, sizeof(av), s.avg());
+    formatUs(p99, sizeof(p99), s.percentile(99));
+    formatUs(mx, sizeof(mx), s.max());
+    snprintf(line, sizeof(line), "# perf %-6s %lu %s/%s/%s/%s", PERF_SLOT_NAMES[i],
+             (unsigned long)s.count(), mn, av, p99, mx);
+    out.println(line);
+  }
+}
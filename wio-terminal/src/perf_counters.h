@@ -0,0 +1,83 @@
+#pragma once
+#include <stdint.h>
+#include "config.h"
+
+class Print;
+
+// Instrumented sections. Names (for the dump and overlay) are in PERF_SLOT_NAMES.
+enum PerfSlot : uint8_t {
+  PERF_PARSE,       // one BLE packet or serial burst through the parsers
+  PERF_DRAW_BAR,    // one bar widget redraw
+  PERF_DRAW_VALUE,  // one value widget redraw
+  PERF_SPARKS,      // sparkline scroll + push
+  PERF_STATUS,      // status strip
+  PERF_NOTIFY,      // BLE re-broadcast of a sample
+  PERF_FRAME,       // whole frame: widgets, sparklines, status
+  PERF_LOOP,        // one loop() pass, excluding idle sleep
+  PERF_SLOT_COUNT
+};
+
+extern const char *const PERF_SLOT_NAMES[PERF_SLOT_COUNT];
+
+// Cycle statistics for one section: exact min/max/mean plus a log-linear
+// histogram (4 buckets per power of two, so percentiles are within ~19%).
+// When a bucket would overflow, all buckets are halved, which keeps the
+// distribution's shape and therefore the percentiles.
+class PerfStat {
+public:
+  void record(uint32_t cycles);
+  void reset();
+
+  uint32_t count() const { return n; }
+  uint32_t min() const { return n ? lo : 0; }
+  uint32_t max() const { return hi; }
+  uint32_t avg() const { return n ? (uint32_t)(sum / n) : 0; }
+  // Upper bound of the bucket holding the pct-th percentile
+  uint32_t percentile(uint8_t pct) const;
+
+  static const uint8_t BUCKETS = 128;
+
+private:
+  static uint8_t bucketOf(uint32_t cycles);
+  static uint32_t bucketTop(uint8_t b);
+
+  uint32_t n = 0;
+  uint32_t lo = UINT32_MAX;
+  uint32_t hi = 0;
+  uint64_t sum = 0;
+  uint16_t hist[BUCKETS] = {};
+};
+
+extern PerfStat perfStats[PERF_SLOT_COUNT];
+
+// Start the cycle counter (DWT CYCCNT on the Cortex-M4)
+void perfBegin();
+// Free-running cycle count; on targets without DWT, microseconds
+uint32_t perfNow();
+// Cycles per microsecond at full clock, for converting the counts
+uint32_t perfCyclesPerUs();
+// The core clock is now F_CPU / div (Power::setSlow). Sections timed from then on
+// are scaled to full-clock cycles, so one window can mix both speeds.
+void perfSetClockDiv(uint8_t div);
+// Current scale for DWT counts; stays 1 where perfNow() is in microseconds
+extern uint8_t perfClockDiv;
+void perfReset();
+// Print every section as a "#"-prefixed line: count, then min/avg/p99/max in us
+void perfDump(Print &out);
+
+// Times the enclosing scope into one slot
+class PerfScope {
+public:
+  explicit PerfScope(PerfSlot s) : slot(s), start(perfNow()) {}
+  ~PerfScope() { perfStats[slot].record((perfNow() - start) * perfClockDiv); }
+
+private:
+  PerfSlot slot;
+  uint32_t start;
+};
+
+#if WIO_PERF
+#define PERF_SCOPE(slot) PerfScope perfScope_(slot)
+#else
+#define PERF_SCOPE(slot) do {} while (0)
+#endif
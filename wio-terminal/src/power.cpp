@@ -0,0 +1,44 @@
+#include "power.h"
+#include "config.h"
+#include "perf_counters.h"
+
+Power power;
+
+#if defined(__SAMD51__) && WIO_LOW_POWER
+#include <Arduino.h>
+
+void Power::begin() {
+  // WFI enters IDLE: the CPU stops, clocks and peripherals keep running
+  PM->SLEEPCFG.reg = PM_SLEEPCFG_SLEEPMODE_IDLE;
+  while (PM->SLEEPCFG.bit.SLEEPMODE != PM_SLEEPCFG_SLEEPMODE_IDLE_Val) {}
+  SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+}
+
+void Power::idle() {
+  __DSB();
+  __WFI();
+}
+
+void Power::setSlow(bool slow) {
+  if (slow == isSlow) return;
+  uint32_t div = slow ? LCD_OFF_CPU_DIV : 1;
+  uint32_t oldDiv = isSlow ? LCD_OFF_CPU_DIV : 1;
+  noInterrupts();
+  GCLK->GENCTRL[0].bit.DIV = div;
+  while (GCLK->SYNCBUSY.bit.GENCTRL0) {}
+  // Same tick period at the new core clock
+  SysTick->LOAD = (SysTick->LOAD + 1) * oldDiv / div - 1;
+  SysTick->VAL = 0;
+  SystemCoreClock = F_CPU / div;
+  interrupts();
+  perfSetClockDiv((uint8_t)div);
+  isSlow = slow;
+}
+
+#else
+
+void Power::begin() {}
+void Power::idle() {}
+void Power::setSlow(bool slow) { isSlow = slow; }
+
+#endif
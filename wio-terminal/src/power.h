@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+
+// MCU power control for a unit that runs around the clock.
+//
+// idle() halts the core with WFI until the next interrupt: the 1 ms SysTick,
+// USB CDC, or the SERCOM UART behind rpcBLE. The chip stays in IDLE sleep
+// rather than STANDBY, so USB and the peripheral clocks keep running and wake
+// latency is one millisecond at most.
+//
+// setSlow() divides the CPU clock (GCLK0) while the screen is dark. SERCOMs and
+// USB run from GCLK1, so serial and BLE baud rates are unaffected. The SysTick
+// reload is rescaled so millis() and the RTOS tick keep their rate.
+//
+// On other targets, or with WIO_LOW_POWER=0, every call is a no-op.
+class Power {
+public:
+  void begin();
+  void idle();
+  void setSlow(bool slow);
+  bool slow() const { return isSlow; }
+
+private:
+  bool isSlow = false;
+};
+
+extern Power power;
@@ -0,0 +1,276 @@
+#include "protocol.h"
+
+uint8_t crc8Update(uint8_t crc, uint8_t b) {
+  crc ^= b;
+  for (int i = 0; i < 8; ++i) {
+    crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+size_t encodeFrame(uint8_t type, const uint8_t *payload, size_t len, uint8_t *out, size_t cap) {
+  if (len > FRAME_MAX_PAYLOAD || cap < len + 5) return 0;
+  out[0] = FRAME_SYNC;
+  out[1] = FRAME_VERSION;
+  out[2] = type;
+  out[3] = (uint8_t)len;
+  uint8_t crc = 0;
+  for (int i = 1; i < 4; ++i) crc = crc8Update(crc, out[i]);
+  for (size_t i = 0; i < len; ++i) {
+    out[4 + i] = payload[i];
+    crc = crc8Update(crc, payload[i]);
+  }
+  out[4 + len] = crc;
+  return len + 5;
+}
+
+size_t encodeSampleFrame(const Metrics &m, uint8_t mask, uint8_t *out, size_t cap) {
+  uint8_t payload[1 + 2 * FIELD_LEGACY_COUNT];
+  size_t n = 0;
+  payload[n++] = mask & FIELD_MASK_ALL;
+  for (uint8_t f = 0; f < FIELD_LEGACY_COUNT; ++f) {
+    if (!(mask & (1u << f))) continue;
+    int16_t t = m.v[f];
+    payload[n++] = (uint8_t)(t & 0xFF);
+    payload[n++] = (uint8_t)((uint16_t)t >> 8);
+  }
+  return encodeFrame(FRAME_SAMPLE, payload, n, out, cap);
+}
+
+uint8_t fieldsBeyondDeadband(const Metrics &a, const Metrics &b, int deadbandTenths) {
+  uint8_t mask = 0;
+  for (uint8_t f = 0; f < FIELD_LEGACY_COUNT; ++f) {
+    int d = (int)a.v[f] - (int)b.v[f];
+    if (d < 0) d = -d;
+    if (d > 0 && d >= deadbandTenths) mask |= (1u << f);
+  }
+  return mask;
+}
+
+FrameDecoder::Result FrameDecoder::feed(uint8_t b) {
+  switch (state) {
+    case WAIT_SYNC:
+      if (b == FRAME_SYNC) state = WAIT_VER;
+      return NEED_MORE;
+    case WAIT_VER:
+      if (b != FRAME_VERSION) { state = WAIT_SYNC; return FRAME_ERROR; }
+      crc = crc8Update(0, b);
+      state = WAIT_TYPE;
+      return NEED_MORE;
+    case WAIT_TYPE:
+      frameType = b;
+      crc = crc8Update(crc, b);
+      state = WAIT_LEN;
+      return NEED_MORE;
+    case WAIT_LEN:
+      if (b > FRAME_MAX_PAYLOAD) { state = WAIT_SYNC; return FRAME_ERROR; }
+      len = b;
+      pos = 0;
+      crc = crc8Update(crc, b);
+      state = len ? IN_PAYLOAD : WAIT_CRC;
+      return NEED_MORE;
+    case IN_PAYLOAD:
+      buf[pos++] = b;
+      crc = crc8Update(crc, b);
+      if (pos >= len) state = WAIT_CRC;
+      return NEED_MORE;
+    case WAIT_CRC:
+      state = WAIT_SYNC;
+      if (b != crc) { crcErrors++; return FRAME_ERROR; }
+      return FRAME_OK;
+  }
+  state = WAIT_SYNC;
+  return FRAME_ERROR;
+}
+
+bool decodeSampleFrame(const uint8_t *payload, size_t len, Metrics &m) {
+  if (len < 1) return false;
+  uint8_t mask = payload[0];
+  size_t need = 1;
+  for (int f = 0; f < FIELD_LEGACY_COUNT; ++f) if (mask & (1u << f)) need += 2;
+  if (len < need) return false;
+
+  const uint8_t *p = payload + 1;
+  for (int f = 0; f < FIELD_LEGACY_COUNT; ++f) {
+    if (!(mask & (1u << f))) continue;
+    int16_t tenths = (int16_t)(p[0] | (p[1] << 8));
+    p += 2;
+    m.v[f] = tenths;
+  }
+  return true;
+}
+
+bool BatchReader::begin(const uint8_t *payload, size_t len) {
+  left = 0;
+  if (len < HEADER) return false;
+  uint8_t count = payload[0];
+  mask = payload[1] & FIELD_MASK_ALL;
+  t0 = (uint32_t)payload[2] | ((uint32_t)payload[3] << 8) | ((uint32_t)payload[4] << 16) |
+       ((uint32_t)payload[5] << 24);
+  size_t record = 2;
+  for (int f = 0; f < FIELD_LEGACY_COUNT; ++f) if (mask & (1u << f)) record += 2;
+  if (count == 0 || len < HEADER + count * record) return false;
+  p = payload + HEADER;
+  left = count;
+  return true;
+}
+
+bool BatchReader::next(Metrics &m, uint32_t &hostMs) {
+  if (left == 0) return false;
+  hostMs = t0 + (uint32_t)(p[0] | (p[1] << 8));
+  p += 2;
+  for (int f = 0; f < FIELD_LEGACY_COUNT; ++f) {
+    if (!(mask & (1u << f))) continue;
+    m.v[f] = (int16_t)(p[0] | (p[1] << 8));
+    p += 2;
+  }
+  left--;
+  return true;
+}
+
+void LineParser::reset() {
+  field = 0;
+  chars = 0;
+  overflow = false;
+  num = NUM_START;
+  neg = false;
+  tenths = 0;
+  fracDigits = 0;
+  roundUp = false;
+}
+
+void LineParser::endField() {
+  if (field < FIELD_LEGACY_COUNT) {
+    int32_t v = tenths + (roundUp ? 1 : 0);
+    if (v > 32767) v = 32767;
+    fields[field] = (int16_t)(neg ? -v : v);
+  }
+  field++;
+  num = NUM_START;
+  neg = false;
+  tenths = 0;
+  fracDigits = 0;
+  roundUp = false;
+}
+
+void LineParser::apply(Metrics &out) const {
+  for (uint8_t f = 0; f < FIELD_LEGACY_COUNT; ++f) out.v[f] = fields[f];
+}
+
+LineParser::Result LineParser::feed(char c) {
+  if (c == '\r') return NEED_MORE;
+  if (c == '\n') {
+    if (chars == 0) return NEED_MORE; // blank line
+    bool ok = !overflow;
+    endField();
+    ok = ok && field >= FIELD_LEGACY_COUNT;
+    reset();
+    return ok ? LINE_OK : LINE_ERROR;
+  }
+  // guard against runaway input: drop the rest of the line
+  if (chars >= MAX_LINE) { overflow = true; return NEED_MORE; }
+  chars++;
+
+  if (c == ',') { endField(); return NEED_MORE; }
+  if (num == NUM_DONE || field >= FIELD_LEGACY_COUNT) return NEED_MORE;
+
+  if (c >= '0' && c <= '9') {
+    int d = c - '0';
+    if (num == NUM_FRAC) {
+      if (fracDigits == 0) tenths += d;
+      else if (fracDigits == 1) roundUp = d >= 5;
+      if (fracDigits < 2) fracDigits++;
+    } else {
+      num = NUM_INT;
+      if (tenths < 100000) tenths = tenths * 10 + d * 10;
+    }
+  } else if (c == '.' && num != NUM_FRAC) {
+    num = NUM_FRAC;
+  } else if ((c == '-' || c == '+') && num == NUM_START) {
+    neg = (c == '-');
+    num = NUM_INT;
+  } else if ((c == ' ' || c == '\t') && num == NUM_START) {
+    // leading blank
+  } else {
+    num = NUM_DONE; // trailing junk, like toFloat()
+  }
+  return NEED_MORE;
+}
+
+bool applySchemaFrame(FieldSchema &schema, const uint8_t *payload, size_t len) {
+  if (len < 3) return false;
+  uint8_t id = payload[0], total = payload[1], start = payload[2];
+  size_t n = len - 3;
+  if (id == 0 || total > FIELD_COUNT || start + n > total) return false;
+  if (start == 0) {
+    // New table: the old one stays usable until this one is complete
+    schema.pendingId = id;
+    schema.received = 0;
+  }
+  if (id != schema.pendingId || start != schema.received) return false; // lost a chunk
+  for (size_t i = 0; i < n; ++i) schema.fields[start + i] = payload[3 + i];
+  schema.received = (uint8_t)(start + n);
+  if (schema.received < total) {
+    if (schema.id == id) schema.id = 0; // same id being rewritten: not usable meanwhile
+    return false;
+  }
+  schema.id = id;
+  schema.count = total;
+  return true;
+}
+
+ValuesResult decodeValuesFrame(const FieldSchema &schema, const uint8_t *payload, size_t len, Metrics &m) {
+  if (len < 2 || (len & 1)) return VALUES_BAD;
+  uint8_t id = payload[0], start = payload[1];
+  if (id == 0 || id != schema.id) return VALUES_UNKNOWN_SCHEMA;
+  size_t n = (len - 2) / 2;
+  if (start + n > schema.count) return VALUES_BAD;
+  const uint8_t *p = payload + 2;
+  for (size_t i = 0; i < n; ++i, p += 2) {
+    uint8_t field = schema.fields[start + i];
+    if (field < FIELD_COUNT) m.v[field] = (int16_t)(p[0] | (p[1] << 8));
+  }
+  return (start + n == schema.count) ? VALUES_COMPLETE : VALUES_PARTIAL;
+}
+
+size_t parseHostPrefix(const uint8_t *data, size_t n, uint8_t &hostId, const uint8_t *&name, size_t &nameLen) {
+  if (n < 6 || data[0] != FRAME_SYNC || data[1] != FRAME_VERSION || data[2] != FRAME_HOST) return 0;
+  size_t len = data[3];
+  if (len < 1 || len > 1 + HOST_NAME_MAX || n < len + 5) return 0;
+  uint8_t crc = 0;
+  for (size_t i = 1; i < len + 4; ++i) crc = crc8Update(crc, data[i]);
+  if (crc != data[len + 4]) return 0;
+  hostId = data[4];
+  name = data + 5;
+  nameLen = len - 1;
+  return len + 5;
+}
+
+size_t encodeCapsFrame(uint8_t *out, size_t cap) {
+  const uint8_t payload[4] = { FRAME_VERSION, FIELD_COUNT, (uint8_t)FRAME_MAX_PAYLOAD, FIELD_LEGACY_COUNT };
+  return encodeFrame(FRAME_CAPS, payload, sizeof(payload), out, cap);
+}
+
+size_t encodeRateFrame(const RateAdvice &a, uint8_t *out, size_t cap) {
+  uint8_t payload[4] = { a.state, (uint8_t)(a.intervalMs & 0xFF), (uint8_t)(a.intervalMs >> 8), a.reasons };
+  return encodeFrame(FRAME_RATE, payload, sizeof(payload), out, cap);
+}
+
+bool decodeStampFrame(const uint8_t *payload, size_t len, uint16_t &seq, uint32_t &hostMs) {
+  if (len < 6) return false;
+  seq = (uint16_t)(payload[0] | (payload[1] << 8));
+  hostMs = (uint32_t)payload[2] | ((uint32_t)payload[3] << 8) | ((uint32_t)payload[4] << 16) |
+           ((uint32_t)payload[5] << 24);
+  return true;
+}
+
+size_t encodeEchoFrame(const EchoReport &e, uint8_t *out, size_t cap) {
+  const uint8_t payload[12] = {
+    (uint8_t)e.seq, (uint8_t)(e.seq >> 8),
+    (uint8_t)e.hostMs, (uint8_t)(e.hostMs >> 8), (uint8_t)(e.hostMs >> 16), (uint8_t)(e.hostMs >> 24),
+    e.flags, e.lost,
+    (uint8_t)e.drawMs, (uint8_t)(e.drawMs >> 8),
+    (uint8_t)e.sendMs, (uint8_t)(e.sendMs >> 8),
+  };
+  return encodeFrame(FRAME_ECHO, payload, sizeof(payload), out, cap);
+}
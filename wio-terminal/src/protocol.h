@@ -0,0 +1,231 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "metrics.h"
+
+// Binary framed metrics protocol (sits alongside the CSV line format).
+//
+// Frame layout (all multi-byte values little-endian):
+//   [SYNC 0xA5][VER][TYPE][LEN][PAYLOAD x LEN][CRC8]
+// CRC8 is CRC-8/ATM (poly 0x07, init 0x00) over VER..PAYLOAD.
+//
+// FRAME_SAMPLE payload:
+//   [MASK] then one int16 per set bit, in field order CPU, TEMP, RAM, GPU, GPUTEMP.
+//   Values are fixed-point tenths (421 => 42.1). Fields not present in MASK keep
+//   their previous value, so a sender may transmit only what changed.
+//
+// Schema protocol, for any number of fields (per-core load, fans, net, disk...):
+//   FRAME_CAPS   (device -> host): [proto version][max fields][max payload][legacy fields]
+//     Advertises what the device can take. Sent in reply to values for a schema the
+//     device does not know, and kept readable on the BLE TX characteristic.
+//   FRAME_SCHEMA (host -> device): [schema id][total count][start][field id x n]
+//     Field-ID table (MetricField values), sent once; split across frames by start.
+//   FRAME_VALUES (host -> device): [schema id][start][int16 x n]
+//     Values in schema order from `start`. A sample is committed once the frame
+//     holding the last schema entry arrives. Field IDs the device does not know are
+//     skipped, so old firmware keeps working with newer senders.
+// Schema id 0 means "no schema".
+//
+// FRAME_HOST (host -> device): [host id][name x 0..HOST_NAME_MAX]
+//   Identifies the sending PC when several share the device. Over BLE, a write that
+//   starts with a HOST frame belongs to that host, so tagged senders put one (id
+//   only, 6 bytes) at the front of every write and send the name now and then.
+//   Untagged writes belong to host 0. On serial it only names the stream.
+//
+// FRAME_BATCH (host -> device): [count][mask][t0 ms, uint32] then count records of
+//   [dt ms, uint16][int16 per set bit]
+//   Several FRAME_SAMPLEs in one BLE write. Every record carries the same fields
+//   (mask as in FRAME_SAMPLE); dt is the sample's time on the host's clock minus t0.
+//   Records are oldest first. All of them go into the history, the newest is drawn.
+//
+// FRAME_RATE (device -> host): [state][interval ms, uint16][reasons]
+//   Pacing advice, sent on the BLE TX characteristic and on Serial when it changes
+//   (and repeated while it is not the default). state RATE_PAUSE asks the host to
+//   stop sampling altogether; otherwise `interval` is the shortest send interval the
+//   device wants (0 = host's own choice). `reasons` are RATE_REASON_* bits.
+//
+// FRAME_STAMP (host -> device): [seq, uint16][host ms, uint32]
+//   Latency probe. Tags the next sample the same stream completes (SAMPLE, BATCH,
+//   the last VALUES chunk or a CSV line), so senders put it in the same write,
+//   just in front of the sample.
+// FRAME_ECHO (device -> host): [seq, uint16][host ms, uint32][flags][lost]
+//   [draw ms, uint16][send ms, uint16]
+//   Answer to a stamp, on the transport it came in on, once the sample is on screen.
+//   seq and host ms are the stamp's. draw and send are on the device clock, from the
+//   sample being parsed to the end of the frame that drew it and to this echo going
+//   out. `lost` counts the sequence numbers skipped just before this one.
+//   `flags` are ECHO_* bits.
+//
+// The sync byte is outside printable ASCII, so it can never start a CSV line and
+// the receiver can auto-detect the format per message.
+
+const uint8_t FRAME_SYNC = 0xA5;
+const uint8_t FRAME_VERSION = 1;
+const uint8_t FRAME_SAMPLE = 0x01;
+const uint8_t FRAME_SCHEMA = 0x02;
+const uint8_t FRAME_VALUES = 0x03;
+const uint8_t FRAME_HOST = 0x04;
+const uint8_t FRAME_BATCH = 0x05;
+const uint8_t FRAME_STAMP = 0x06;
+const uint8_t FRAME_CAPS = 0x10;
+const uint8_t FRAME_RATE = 0x11;
+const uint8_t FRAME_ECHO = 0x12;
+const size_t HOST_NAME_MAX = 11;
+const size_t FRAME_MAX_PAYLOAD = 240;
+
+uint8_t crc8Update(uint8_t crc, uint8_t b);
+
+const uint8_t FIELD_MASK_ALL = (1u << FIELD_LEGACY_COUNT) - 1;
+// Largest FRAME_SAMPLE on the wire (all fields present)
+const size_t SAMPLE_FRAME_MAX = 5 + 1 + 2 * FIELD_LEGACY_COUNT;
+
+// Byte-at-a-time frame decoder; keeps no heap state and never blocks.
+class FrameDecoder {
+public:
+  enum Result : uint8_t { NEED_MORE, FRAME_OK, FRAME_ERROR };
+
+  Result feed(uint8_t b);
+  // True while a frame is in progress (sync seen, waiting for the rest)
+  bool active() const { return state != WAIT_SYNC; }
+  void reset() { state = WAIT_SYNC; }
+
+  uint8_t type() const { return frameType; }
+  uint8_t length() const { return len; }
+  const uint8_t *payload() const { return buf; }
+
+  uint32_t crcErrors = 0;
+
+private:
+  enum State : uint8_t { WAIT_SYNC, WAIT_VER, WAIT_TYPE, WAIT_LEN, IN_PAYLOAD, WAIT_CRC };
+  State state = WAIT_SYNC;
+  uint8_t frameType = 0;
+  uint8_t len = 0;
+  uint8_t pos = 0;
+  uint8_t crc = 0;
+  uint8_t buf[FRAME_MAX_PAYLOAD];
+};
+
+// Wrap `payload` in a frame; returns bytes written, or 0 if it does not fit in `cap`
+size_t encodeFrame(uint8_t type, const uint8_t *payload, size_t len, uint8_t *out, size_t cap);
+// Encode the fields of `m` selected by `mask` as a FRAME_SAMPLE (0 if it does not fit)
+size_t encodeSampleFrame(const Metrics &m, uint8_t mask, uint8_t *out, size_t cap);
+// Mask of fields whose tenths differ between `a` and `b` by at least `deadbandTenths`
+uint8_t fieldsBeyondDeadband(const Metrics &a, const Metrics &b, int deadbandTenths);
+
+// Apply a FRAME_SAMPLE payload onto `m` (fields absent from the mask are left untouched)
+bool decodeSampleFrame(const uint8_t *payload, size_t len, Metrics &m);
+
+// Walks the records of a FRAME_BATCH payload without copying it
+class BatchReader {
+public:
+  // Validate the header and size; false for a malformed batch
+  bool begin(const uint8_t *payload, size_t len);
+  // Apply the next record onto `m` and give its host time; false when done
+  bool next(Metrics &m, uint32_t &hostMs);
+  uint8_t remaining() const { return left; }
+
+  static const size_t HEADER = 6;
+
+private:
+  const uint8_t *p = nullptr;
+  uint32_t t0 = 0;
+  uint8_t mask = 0;
+  uint8_t left = 0;
+};
+
+// Streaming parser for the CSV line format "CPU,TEMP,RAM,GPU,GPUTEMP\n".
+// Numbers are accumulated digit by digit as bytes arrive, straight into fixed-point
+// tenths (rounded on the second decimal), so there is no line buffer, no float and
+// nothing is allocated per sample. Like String::toFloat(), each field takes the
+// leading number and ignores trailing junk; surrounding blanks are skipped.
+class LineParser {
+public:
+  enum Result : uint8_t { NEED_MORE, LINE_OK, LINE_ERROR };
+
+  Result feed(char c);
+  // After LINE_OK: copy the line's fields onto `out` (extended fields untouched)
+  void apply(Metrics &out) const;
+  // True when no byte of the current line has been consumed yet
+  bool atLineStart() const { return chars == 0; }
+  void reset();
+
+  static const uint8_t MAX_LINE = 128;
+
+private:
+  enum NumState : uint8_t { NUM_START, NUM_INT, NUM_FRAC, NUM_DONE };
+  void endField();
+
+  int16_t fields[FIELD_LEGACY_COUNT];
+  uint8_t field = 0;
+  uint8_t chars = 0;
+  bool overflow = false;
+  NumState num = NUM_START;
+  bool neg = false;
+  int32_t tenths = 0;
+  uint8_t fracDigits = 0;
+  bool roundUp = false;
+};
+
+// Field-ID table received through FRAME_SCHEMA (one per transport)
+struct FieldSchema {
+  uint8_t id = 0;          // 0 => none / incomplete
+  uint8_t count = 0;
+  uint8_t received = 0;
+  uint8_t pendingId = 0;   // schema being assembled
+  uint8_t fields[FIELD_COUNT];
+};
+
+// Apply one FRAME_SCHEMA chunk; returns true once the table is complete
+bool applySchemaFrame(FieldSchema &schema, const uint8_t *payload, size_t len);
+
+enum ValuesResult : uint8_t { VALUES_BAD, VALUES_UNKNOWN_SCHEMA, VALUES_PARTIAL, VALUES_COMPLETE };
+// Apply one FRAME_VALUES chunk onto `m`; cost is linear in the values carried
+ValuesResult decodeValuesFrame(const FieldSchema &schema, const uint8_t *payload, size_t len, Metrics &m);
+
+// If `data` starts with a complete, valid FRAME_HOST, return its length and fill
+// `hostId` and the (unterminated) name; otherwise return 0 and touch nothing
+size_t parseHostPrefix(const uint8_t *data, size_t n, uint8_t &hostId, const uint8_t *&name, size_t &nameLen);
+
+// Build this device's FRAME_CAPS
+size_t encodeCapsFrame(uint8_t *out, size_t cap);
+
+enum RateState : uint8_t { RATE_RUN = 0, RATE_PAUSE = 1 };
+enum RateReason : uint8_t {
+  RATE_REASON_LCD_OFF = 0x01,   // screen is off: nothing would be shown
+  RATE_REASON_BACKLOG = 0x02,   // samples arrive faster than they are drawn
+  RATE_REASON_LINK    = 0x04,   // CRC errors or RX ring overruns on the link
+};
+
+// Pacing advice carried by FRAME_RATE
+struct RateAdvice {
+  uint8_t state = RATE_RUN;
+  uint16_t intervalMs = 0;
+  uint8_t reasons = 0;
+
+  bool operator==(const RateAdvice &o) const {
+    return state == o.state && intervalMs == o.intervalMs && reasons == o.reasons;
+  }
+  bool operator!=(const RateAdvice &o) const { return !(*this == o); }
+};
+
+size_t encodeRateFrame(const RateAdvice &a, uint8_t *out, size_t cap);
+
+enum EchoFlag : uint8_t {
+  ECHO_SUPERSEDED = 0x01,   // a newer sample replaced it before it was drawn
+  ECHO_OFFSCREEN  = 0x02,   // not drawn: another source or the stats overlay was shown
+  ECHO_UNTIMED    = 0x04,   // too many samples waiting for a frame: echoed unmeasured
+};
+
+// Device-side timing for one FRAME_STAMP, carried by FRAME_ECHO
+struct EchoReport {
+  uint16_t seq = 0;
+  uint32_t hostMs = 0;
+  uint8_t flags = 0;
+  uint8_t lost = 0;
+  uint16_t drawMs = 0;
+  uint16_t sendMs = 0;
+};
+
+// Read a FRAME_STAMP payload; false if it is too short
+bool decodeStampFrame(const uint8_t *payload, size_t len, uint16_t &seq, uint32_t &hostMs);
+size_t encodeEchoFrame(const EchoReport &e, uint8_t *out, size_t cap);
@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+#include "protocol.h"
+
+// What the device saw during one evaluation window (counters are cumulative)
+struct RateInputs {
+  bool lcdOn;
+  uint32_t samples;     // samples handed to the renderer
+  uint32_t dropped;     // of those, superseded before they were drawn
+  uint32_t linkErrors;  // frame CRC errors + RX ring overruns
+};
+
+// Turns render backlog, link errors and screen state into pacing advice for the
+// hosts. Backs off quickly (doubling the interval) and recovers slowly (halving it
+// after several clean windows), so a marginal link does not make the rate oscillate.
+class RateAdvisor {
+public:
+  RateAdvisor(uint16_t minIntervalMs, uint16_t maxIntervalMs)
+    : minMs(minIntervalMs), maxMs(maxIntervalMs) {}
+
+  // Evaluate one window of `windowMs`; returns true when the advice changed
+  bool update(const RateInputs &in, uint32_t windowMs) {
+    uint32_t dSamples = in.samples - lastSamples;
+    uint32_t dDropped = in.dropped - lastDropped;
+    uint32_t dErrors = in.linkErrors - lastErrors;
+    lastSamples = in.samples;
+    lastDropped = in.dropped;
+    lastErrors = in.linkErrors;
+
+    RateAdvice next;
+    if (!in.lcdOn) {
+      next.state = RATE_PAUSE;
+      next.reasons = RATE_REASON_LCD_OFF;
+      floorMs = 0;
+      cleanWindows = 0;
+    } else {
+      uint8_t reasons = 0;
+      if (dSamples > 0 && dDropped * 2 > dSamples) reasons |= RATE_REASON_BACKLOG;
+      if (dErrors > 0) reasons |= RATE_REASON_LINK;
+      if (reasons) {
+        // Slow down: at least twice the interval the host is sending at now
+        uint32_t seen = dSamples ? windowMs / dSamples : windowMs;
+        uint32_t want = floorMs * 2;
+        if (want < seen * 2) want = seen * 2;
+        if (want < minMs) want = minMs;
+        floorMs = want > maxMs ? maxMs : (uint16_t)want;
+        cleanWindows = 0;
+        held = reasons;
+      } else if (floorMs && ++cleanWindows >= RECOVER_WINDOWS) {
+        // Speed back up one step at a time
+        floorMs = floorMs / 2 < minMs ? 0 : floorMs / 2;
+        cleanWindows = 0;
+        if (!floorMs) held = 0;
+      }
+      next.intervalMs = floorMs;
+      next.reasons = floorMs ? held : 0;
+    }
+    bool changed = next != current;
+    current = next;
+    return changed;
+  }
+
+  const RateAdvice &advice() const { return current; }
+  // True when the advice differs from "run at your own pace"
+  bool restricting() const { return current != RateAdvice(); }
+
+  static const uint8_t RECOVER_WINDOWS = 5;
+
+private:
+  uint16_t minMs, maxMs;
+  uint16_t floorMs = 0;
+  uint8_t cleanWindows = 0;
+  uint8_t held = 0;          // reasons behind the current floor
+  uint32_t lastSamples = 0, lastDropped = 0, lastErrors = 0;
+  RateAdvice current;
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <stdint.h>
+#include "metrics.h"
+
+// Latest-value render scheduler. Incoming samples overwrite a single pending
+// slot; the display takes it at most once per frame interval, so drawing runs
+// at panel rate no matter how fast the sender pushes. No queue grows, so the
+// age of what gets drawn is bounded by one frame interval plus one draw.
+class RenderScheduler {
+public:
+  explicit RenderScheduler(uint32_t maxFps) { setMaxFps(maxFps); }
+
+  void setMaxFps(uint32_t fps) { frameIntervalMs = fps ? 1000 / fps : 0; }
+
+  void submit(const Metrics &m, uint32_t now) {
+    if (pendingCount > 0) dropped++;   // previous pending sample never reaches the screen
+    else pendingSince = now;
+    pendingCount++;
+    pending = m;
+    hasPending = true;
+    samples++;
+  }
+
+  // Draw `m` in the next frame without counting it as a sample. Page switches,
+  // relayouts and recolours are not input, and must not look like a backlog to
+  // the pacing advice, which reads the counters below.
+  void invalidate(const Metrics &m) {
+    pending = m;
+    hasPending = true;
+  }
+
+  // Keep frames coming without new samples while something on screen is still
+  // moving; take() then returns the last sample again
+  void setAnimating(bool on) { animating = on; }
+
+  bool due(uint32_t now) const { return (hasPending || animating) && (now - lastFrameMs) >= frameIntervalMs; }
+  // True when the frame due() announces carries a new sample
+  bool fresh() const { return pendingCount > 0; }
+
+  // Milliseconds until a frame may be drawn (0 = now, UINT32_MAX = nothing pending)
+  uint32_t msUntilDue(uint32_t now) const {
+    if (!hasPending && !animating) return UINT32_MAX;
+    uint32_t since = now - lastFrameMs;
+    return since >= frameIntervalMs ? 0 : frameIntervalMs - since;
+  }
+
+  // Take the pending sample for drawing; call only when due()
+  Metrics take(uint32_t now) {
+    lastFrameMs = now;
+    if (!hasPending) {
+      animFrames++;
+      return pending;
+    }
+    hasPending = false;
+    if (pendingCount == 0) {
+      redraws++;
+      return pending;
+    }
+    frames++;
+    if (pendingCount > 1) coalesced++;
+    pendingCount = 0;
+    uint32_t age = now - pendingSince;
+    if (age > maxLatencyMs) maxLatencyMs = age;
+    return pending;
+  }
+
+  // Counters
+  uint32_t samples = 0;      // samples submitted
+  uint32_t frames = 0;       // frames drawn for new samples
+  uint32_t animFrames = 0;   // frames drawn only to advance an animation
+  uint32_t redraws = 0;      // frames drawn for invalidate() alone
+  uint32_t dropped = 0;      // samples superseded before they were drawn
+  uint32_t coalesced = 0;    // frames that absorbed more than one sample
+  uint32_t maxLatencyMs = 0; // worst submit-to-draw delay seen
+
+private:
+  Metrics pending;
+  bool hasPending = false;
+  bool animating = false;
+  uint32_t pendingSince = 0;
+  uint32_t pendingCount = 0;
+  uint32_t lastFrameMs = 0;
+  uint32_t frameIntervalMs = 0;
+};
@@ -0,0 +1,230 @@
+#include "skin.h"
+#include <string.h>
+#include "dashboard.h"
+#include "flash_fs.h"
+#include "lcd_dma.h"
+
+Skin skin;
+
+#if WIO_SKIN && defined(__SAMD51__)
+#include <Arduino.h>
+#include <Seeed_FS.h>
+#include "SFUD/Seeed_SFUD.h"
+
+static const uint8_t SKIN_MAGIC[4] = { 'W', 'S', 'K', '1' };
+static const char *const SKIN_TMP_PATH = "/skin.tmp";
+
+// Decode buffers: one is filled while the other streams out
+static uint16_t skinLine[2][SKIN_LINE_PX];
+static File uploadFile;
+
+static uint16_t get16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+// Header and size check; fills in what draw() needs
+bool Skin::checkFile(const char *path) {
+  File f = SPIFLASH.open(path, FILE_READ);
+  if (!f) return false;
+  uint8_t h[HEADER];
+  bool ok = f.read(h, sizeof(h)) == (int)sizeof(h) && memcmp(h, SKIN_MAGIC, 4) == 0 &&
+            get16(h + 4) == SCREEN_W && get16(h + 6) == SCREEN_H;
+  uint32_t bytes = f.size();
+  f.close();
+  if (!ok || bytes <= HEADER || (bytes - HEADER) % 4 != 0) return false;
+  fileLayout = get16(h + 8);
+  fileSize = bytes;
+  return true;
+}
+
+bool Skin::begin(uint16_t id) {
+  layout = id;
+  if (!flashFsMount()) return false;
+  FlashLock lock;
+  // A captured image of some other layout would show stale labels
+  valid = checkFile(SKIN_PATH) && (fileLayout == 0 || fileLayout == layout);
+  return valid;
+}
+
+// Queue `n` decoded pixels behind the buffer still streaming, if any
+static void flushLine(TFT_eSPI &tft, uint16_t *buf, int n) {
+  if (n == 0) return;
+  if (!lcdDma.start(buf, n, n, 1)) tft.pushColors(buf, n, false);
+}
+
+bool Skin::draw(TFT_eSPI &tft, int y, int h) {
+  if (!valid) return false;
+  if (y < 0) { h += y; y = 0; }
+  if (y + h > SCREEN_H) h = SCREEN_H - y;
+  if (h <= 0) return true;
+  FlashLock lock;
+  File f = SPIFLASH.open(SKIN_PATH, FILE_READ);
+  if (!f) { valid = false; return false; }
+  f.seek(HEADER);
+
+  uint32_t skip = (uint32_t)y * SCREEN_W;
+  uint32_t left = (uint32_t)h * SCREEN_W;
+  static uint8_t in[512];
+  size_t inLen = 0, inPos = 0;
+  int cur = 0, fill = 0;
+  tft.startWrite();
+  tft.setAddrWindow(0, y, SCREEN_W, h);
+  while (left > 0) {
+    if (inPos + 4 > inLen) {
+      size_t rest = inLen - inPos;
+      memmove(in, in + inPos, rest);
+      int got = f.read(in + rest, sizeof(in) - rest);
+      inLen = rest + (got > 0 ? (size_t)got : 0);
+      inPos = 0;
+      if (inLen < 4) break;   // short file: leave the rest as it was
+    }
+    uint32_t count = get16(in + inPos);
+    uint16_t color;
+    memcpy(&color, in + inPos + 2, 2);   // big-endian on disk is panel order in RAM
+    inPos += 4;
+    if (skip >= count) { skip -= count; continue; }
+    count -= skip;
+    skip = 0;
+    if (count > left) count = left;
+    left -= count;
+    // Long runs (background, bar slots) go out as DMA fills of one colour
+    if (count >= SKIN_LINE_PX) {
+      flushLine(tft, skinLine[cur], fill);
+      fill = 0;
+      uint16_t rgb = (uint16_t)((color >> 8) | (color << 8));
+      while (count > 0) {
+        // fill() waits out the line still streaming, so both buffers are free after
+        uint32_t n = count > 8192 ? 8192 : count;
+        if (!lcdDma.fill(rgb, n)) tft.pushBlock(rgb, n);
+        count -= n;
+      }
+      continue;
+    }
+    while (count > 0) {
+      uint32_t n = SKIN_LINE_PX - fill;
+      if (n > count) n = count;
+      for (uint32_t i = 0; i < n; ++i) skinLine[cur][fill++] = color;
+      count -= n;
+      if (fill == SKIN_LINE_PX) {
+        flushLine(tft, skinLine[cur], fill);
+        cur ^= 1;
+        fill = 0;
+      }
+    }
+  }
+  flushLine(tft, skinLine[cur], fill);
+  lcdDma.wait();
+  tft.endWrite();
+  f.close();
+  return true;
+}
+
+bool Skin::capture(TFT_eSPI &tft, RenderFn fn) {
+  if (!flashFsMount()) return false;
+  TFT_eSprite strip(&tft);
+  strip.setColorDepth(16);
+  if (!strip.createSprite(SCREEN_W, SKIN_CAPTURE_ROWS)) return false;
+  FlashLock lock;
+  SPIFLASH.remove(SKIN_TMP_PATH);
+  File f = SPIFLASH.open(SKIN_TMP_PATH, FILE_WRITE);
+  if (!f) { strip.deleteSprite(); return false; }
+  uint8_t out[256];
+  memcpy(out, SKIN_MAGIC, 4);
+  const uint16_t head[4] = { (uint16_t)SCREEN_W, (uint16_t)SCREEN_H, layout, 0 };
+  for (int i = 0; i < 4; ++i) { out[4 + 2 * i] = (uint8_t)head[i]; out[5 + 2 * i] = (uint8_t)(head[i] >> 8); }
+  size_t outLen = HEADER;
+
+  // Runs carry across strip boundaries; colours stay in the sprite's panel order
+  uint16_t runColor = 0;
+  uint32_t runLen = 0;
+  for (int y0 = 0; y0 < SCREEN_H; y0 += SKIN_CAPTURE_ROWS) {
+    int rows = SCREEN_H - y0 < SKIN_CAPTURE_ROWS ? SCREEN_H - y0 : SKIN_CAPTURE_ROWS;
+    strip.fillSprite(TFT_BLACK);
+    fn(strip, y0);
+    const uint16_t *px = (const uint16_t *)strip.getPointer();
+    for (int i = 0; i < rows * SCREEN_W; ++i) {
+      if (runLen > 0 && px[i] == runColor && runLen < 0xFFFF) { runLen++; continue; }
+      if (runLen > 0) {
+        if (outLen + 4 > sizeof(out)) { f.write(out, outLen); outLen = 0; }
+        out[outLen++] = (uint8_t)runLen;
+        out[outLen++] = (uint8_t)(runLen >> 8);
+        memcpy(out + outLen, &runColor, 2);
+        outLen += 2;
+      }
+      runColor = px[i];
+      runLen = 1;
+    }
+  }
+  if (outLen + 4 > sizeof(out)) { f.write(out, outLen); outLen = 0; }
+  out[outLen++] = (uint8_t)runLen;
+  out[outLen++] = (uint8_t)(runLen >> 8);
+  memcpy(out + outLen, &runColor, 2);
+  outLen += 2;
+  f.write(out, outLen);
+  f.close();
+  strip.deleteSprite();
+
+  SPIFLASH.remove(SKIN_PATH);
+  valid = SPIFLASH.rename(SKIN_TMP_PATH, SKIN_PATH) && checkFile(SKIN_PATH);
+  return valid;
+}
+
+void Skin::remove() {
+  if (!flashFsMount()) return;
+  FlashLock lock;
+  SPIFLASH.remove(SKIN_PATH);
+  valid = false;
+  changed = true;
+}
+
+bool Skin::startUpload(uint32_t bytes, uint32_t now) {
+  if (!flashFsMount() || uploadLeft > 0 || bytes <= HEADER) return false;
+  FlashLock lock;
+  SPIFLASH.remove(SKIN_TMP_PATH);
+  uploadFile = SPIFLASH.open(SKIN_TMP_PATH, FILE_WRITE);
+  if (!uploadFile) return false;
+  uploadLeft = bytes;
+  uploadMs = now;
+  return true;
+}
+
+size_t Skin::receive(const uint8_t *data, size_t n, uint32_t now) {
+  if (uploadLeft == 0) return 0;
+  if (n > uploadLeft) n = uploadLeft;
+  FlashLock lock;
+  uploadFile.write(data, n);
+  uploadLeft -= n;
+  uploadMs = now;
+  if (uploadLeft > 0) return n;
+  uploadFile.close();
+  // The current image stays unless the new one is usable
+  uploadOk = checkFile(SKIN_TMP_PATH);
+  if (uploadOk) {
+    SPIFLASH.remove(SKIN_PATH);
+    valid = SPIFLASH.rename(SKIN_TMP_PATH, SKIN_PATH);
+    changed = true;
+  } else {
+    SPIFLASH.remove(SKIN_TMP_PATH);
+  }
+  return n;
+}
+
+bool Skin::service(uint32_t now) {
+  if (uploadLeft == 0 || now - uploadMs < SKIN_UPLOAD_TIMEOUT_MS) return false;
+  FlashLock lock;
+  uploadFile.close();
+  SPIFLASH.remove(SKIN_TMP_PATH);
+  uploadLeft = 0;
+  return true;
+}
+
+#else
+
+bool Skin::checkFile(const char *) { return false; }
+bool Skin::begin(uint16_t id) { layout = id; return false; }
+bool Skin::draw(TFT_eSPI &, int, int) { return false; }
+bool Skin::capture(TFT_eSPI &, RenderFn) { return false; }
+void Skin::remove() {}
+bool Skin::startUpload(uint32_t, uint32_t) { return false; }
+size_t Skin::receive(const uint8_t *, size_t n, uint32_t) { return n; }
+bool Skin::service(uint32_t) { return false; }
+
+#endif
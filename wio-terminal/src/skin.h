@@ -0,0 +1,68 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <TFT_eSPI.h>
+#include "config.h"
+
+// Static background (header, labels, empty bar slots) kept as a run-length
+// encoded image in the SPI flash and streamed back to the panel, instead of being
+// rebuilt from text and fill calls. Uploading a different image ("?skin put")
+// reskins the dashboard without a firmware change.
+//
+// File layout (SKIN_PATH): "WSK1", [width, uint16 LE][height, uint16 LE]
+// [layout id, uint16 LE][reserved, uint16], then runs of [count, uint16 LE]
+// [RGB565 colour, big-endian] covering the image row by row. Width and height
+// must match the panel. Layout id 0 marks a custom skin; anything else is an
+// image the firmware captured itself, and is redone when layoutId() changes.
+//
+// draw() and capture() run on the display owner; uploads arrive in the ingest
+// context. Flash access from both goes through FlashLock.
+class Skin {
+public:
+  // Draw the built-in background on `gfx`: the panel, or a capture strip whose
+  // top row is panel row `yOff`
+  typedef void (*RenderFn)(TFT_eSPI &gfx, int yOff);
+
+  // Mount the flash and look for a usable image for layout `layout`
+  bool begin(uint16_t layout);
+  bool ready() const { return valid; }
+  bool custom() const { return valid && fileLayout == 0; }
+  uint32_t size() const { return fileSize; }
+
+  // Stream panel rows [y, y + h) from the image in one transaction; false, with
+  // nothing drawn, when there is no usable image
+  bool draw(TFT_eSPI &tft, int y, int h);
+  // Render `fn` strip by strip and save the result as the image
+  bool capture(TFT_eSPI &tft, RenderFn fn);
+  // Drop the image; the next layout draws the built-in one and captures it
+  void remove();
+
+  // Receive a custom image of `bytes` bytes through receive()
+  bool startUpload(uint32_t bytes, uint32_t now);
+  bool uploading() const { return uploadLeft > 0; }
+  // Whether the last finished upload was accepted
+  bool uploaded() const { return uploadOk; }
+  // Consume upload bytes from `data`; returns how many were taken. When the last
+  // byte arrives the image is checked and, if good, replaces the current one.
+  size_t receive(const uint8_t *data, size_t n, uint32_t now);
+  // Abandon an upload that stopped arriving; true if one was dropped
+  bool service(uint32_t now);
+  // True once after the image changed and the screen should be laid out again
+  bool takeChanged() { bool c = changed; changed = false; return c; }
+
+  static const size_t HEADER = 12;
+
+private:
+  bool checkFile(const char *path);
+
+  uint16_t layout = 0;
+  uint16_t fileLayout = 0;
+  uint32_t fileSize = 0;
+  volatile bool valid = false;
+  volatile bool changed = false;
+  uint32_t uploadLeft = 0;
+  uint32_t uploadMs = 0;
+  bool uploadOk = false;
+};
+
+extern Skin skin;
@@ -0,0 +1,46 @@
+#include "sparkline.h"
+
+bool Sparkline::begin(uint8_t f, int gx, int gy, int gw, int gh, uint8_t vlo, uint8_t vhi, uint16_t c) {
+  field = f;
+  x = gx;
+  y = gy;
+  w = gw;
+  h = gh;
+  lo = vlo;
+  hi = vhi > vlo ? vhi : vlo + 1;
+  color = c;
+  spr.setColorDepth(8); // 1 byte/pixel is plenty for a two-colour graph
+  ready = spr.createSprite(w, h) != nullptr;
+  if (ready) spr.fillSprite(TFT_BLACK);
+  return ready;
+}
+
+void Sparkline::drawColumn(int col, uint8_t v) {
+  spr.drawFastVLine(col, 0, h, TFT_BLACK);
+  if (v == History::HISTORY_NA) return;
+  int c = v < lo ? lo : (v > hi ? hi : v);
+  int bar = 1 + (c - lo) * (h - 1) / (hi - lo);
+  spr.drawFastVLine(col, h - bar, bar, color);
+}
+
+void Sparkline::update(const History &hist) {
+  if (!ready) return;
+  uint32_t total = hist.pushed();
+  if (!fullRedraw && total == drawnTotal) return;
+
+  uint32_t fresh = total - drawnTotal;
+  if (fullRedraw || fresh >= (uint32_t)w) {
+    // Rebuild every column from history (oldest at the left)
+    spr.fillSprite(TFT_BLACK);
+    uint16_t avail = hist.available();
+    int cols = avail < w ? avail : w;
+    for (int i = 0; i < cols; ++i) drawColumn(w - 1 - i, hist.at(field, (uint16_t)i));
+  } else {
+    // Blit existing pixels left and draw only the new columns
+    spr.scroll(-(int)fresh, 0);
+    for (uint32_t i = 0; i < fresh; ++i) drawColumn(w - 1 - (int)i, hist.at(field, (uint16_t)i));
+  }
+  drawnTotal = total;
+  fullRedraw = false;
+  spr.pushSprite(x, y);
+}
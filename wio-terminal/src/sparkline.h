@@ -0,0 +1,36 @@
+#pragma once
+#include <TFT_eSPI.h>
+#include "config.h"
+#include "history.h"
+
+typedef MetricHistory<HISTORY_LEN> History;
+
+// Scrolling trend graph for one history field. The sprite is scrolled left in
+// RAM by the number of new samples and only those new columns are drawn, so the
+// graph is never rebuilt per sample.
+class Sparkline {
+public:
+  Sparkline(TFT_eSPI *tft) : spr(tft) {}
+
+  // Allocate a w x h sprite graphing `field` with its top-left corner at (x, y).
+  // Values outside lo..hi are clamped to the graph's bottom/top.
+  bool begin(uint8_t field, int x, int y, int w, int h, uint8_t lo, uint8_t hi, uint16_t color);
+  // Draw whatever arrived since the last call and push the sprite
+  void update(const History &hist);
+  // Force a full rebuild from history on the next update (after a screen clear)
+  void invalidate() { drawnTotal = 0; fullRedraw = true; }
+  // Graph colour; a change rebuilds the graph on the next update
+  void setColor(uint16_t c) { if (c != color) { color = c; invalidate(); } }
+
+private:
+  void drawColumn(int col, uint8_t v);
+
+  TFT_eSprite spr;
+  uint8_t field = 0;
+  int x = 0, y = 0, w = 0, h = 0;
+  uint8_t lo = 0, hi = 100;
+  uint16_t color = 0;
+  bool ready = false;
+  bool fullRedraw = true;
+  uint32_t drawnTotal = 0;
+};
@@ -0,0 +1,122 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+// Lock-free single-producer/single-consumer ring of length-prefixed packets.
+// The producer (e.g. the BLE write callback) only touches `head`, the consumer
+// (loop()) only touches `tail`; each publishes with release and observes the
+// other with acquire, so no lock or interrupt masking is needed.
+// A packet that does not fit is dropped as a whole and counted in `overruns`,
+// which keeps frame/line boundaries intact for the parser.
+template <size_t N>
+class PacketRing {
+  static_assert(N >= 4 && (N & (N - 1)) == 0, "PacketRing size must be a power of two");
+
+public:
+  static const size_t HEADER = 2;
+
+  // Producer side
+  bool push(const uint8_t *data, size_t len) {
+    if (len == 0) return true;
+    if (len > 0xFFFF) { overruns.fetch_add(1, std::memory_order_relaxed); return false; }
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t t = tail.load(std::memory_order_acquire);
+    if (N - (h - t) < len + HEADER) {
+      overruns.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    uint8_t hdr[HEADER] = { (uint8_t)(len & 0xFF), (uint8_t)(len >> 8) };
+    copyIn(h, hdr, HEADER);
+    copyIn(h + HEADER, data, len);
+    head.store(h + HEADER + len, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side: copies the oldest packet into `out` and returns its length
+  // (0 when empty). A packet larger than `cap` is truncated.
+  size_t pop(uint8_t *out, size_t cap) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t h = head.load(std::memory_order_acquire);
+    if (h == t) return 0;
+    uint8_t hdr[HEADER];
+    copyOut(t, hdr, HEADER);
+    size_t len = hdr[0] | ((size_t)hdr[1] << 8);
+    size_t n = len < cap ? len : cap;
+    copyOut(t + HEADER, out, n);
+    tail.store(t + HEADER + len, std::memory_order_release);
+    return n;
+  }
+
+  bool empty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed);
+  }
+
+  std::atomic<uint32_t> overruns{0};
+
+private:
+  void copyIn(uint32_t at, const uint8_t *src, size_t n) {
+    size_t i = at & (N - 1);
+    size_t first = (N - i) < n ? (N - i) : n;
+    memcpy(buf + i, src, first);
+    memcpy(buf, src + first, n - first);
+  }
+  void copyOut(uint32_t at, uint8_t *dst, size_t n) const {
+    size_t i = at & (N - 1);
+    size_t first = (N - i) < n ? (N - i) : n;
+    memcpy(dst, buf + i, first);
+    memcpy(dst + first, buf, n - first);
+  }
+
+  std::atomic<uint32_t> head{0};
+  std::atomic<uint32_t> tail{0};
+  uint8_t buf[N];
+};
+
+// Lock-free single-producer/single-consumer byte stream, same discipline as
+// PacketRing. There are no boundaries to keep, so a push stores what fits and
+// reports it; the producer leaves the rest where it came from.
+template <size_t N>
+class ByteRing {
+  static_assert(N >= 4 && (N & (N - 1)) == 0, "ByteRing size must be a power of two");
+
+public:
+  // Producer side
+  size_t space() const {
+    return N - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire));
+  }
+  size_t push(const uint8_t *data, size_t len) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    size_t room = N - (h - tail.load(std::memory_order_acquire));
+    size_t n = len < room ? len : room;
+    size_t i = h & (N - 1);
+    size_t first = (N - i) < n ? (N - i) : n;
+    memcpy(buf + i, data, first);
+    memcpy(buf, data + first, n - first);
+    head.store(h + n, std::memory_order_release);
+    return n;
+  }
+
+  // Consumer side: up to `cap` of the oldest bytes; 0 when empty
+  size_t pop(uint8_t *out, size_t cap) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    size_t avail = head.load(std::memory_order_acquire) - t;
+    size_t n = avail < cap ? avail : cap;
+    size_t i = t & (N - 1);
+    size_t first = (N - i) < n ? (N - i) : n;
+    memcpy(out, buf + i, first);
+    memcpy(out + first, buf, n - first);
+    tail.store(t + n, std::memory_order_release);
+    return n;
+  }
+
+  bool empty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint32_t> head{0};
+  std::atomic<uint32_t> tail{0};
+  uint8_t buf[N];
+};
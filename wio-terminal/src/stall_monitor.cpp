@@ -0,0 +1,166 @@
+#include "stall_monitor.h"
+#include <Arduino.h>
+#include <string.h>
+
+const char *const STALL_PHASE_NAMES[PHASE_COUNT] = {
+  "loop", "setup", "parse", "draw", "notify", "wake", "flash",
+};
+
+StallMonitor stallMonitor;
+
+static const uint32_t STALL_LOG_MAGIC = 0x57535431; // "WST1"
+
+struct StallLog {
+  uint32_t magic;
+  uint16_t boots;
+  uint16_t watchdogResets;
+  uint8_t next;
+  uint8_t count;
+  StallEntry entries[STALL_LOG_LEN];
+};
+
+#if defined(__SAMD51__)
+// Backup RAM is kept through every reset but power-on; the startup code never touches it
+static StallLog &stallLog = *(StallLog *)BKUPRAM_ADDR;
+#else
+static StallLog stallLog;
+#endif
+
+static bool logValid() {
+  return stallLog.magic == STALL_LOG_MAGIC && stallLog.count <= STALL_LOG_LEN && stallLog.next < STALL_LOG_LEN;
+}
+
+#if defined(__SAMD51__) && WDT_PERIOD_MS > 0
+// WDT period codes select 8 << n cycles of the 1.024 kHz WDT clock
+static uint8_t wdtCode(uint32_t ms) {
+  uint32_t cycles = ms * 1024 / 1000;
+  uint8_t n = 0;
+  while (n < 0xB && (8UL << n) < cycles) n++;
+  return n;
+}
+
+extern "C" void WDT_Handler(void) {
+  WDT->INTFLAG.reg = WDT_INTFLAG_EW;
+  stallMonitor.onWatchdogWarning();
+}
+#endif
+
+void StallMonitor::begin() {
+#if defined(__SAMD51__)
+  resetByWatchdog = RSTC->RCAUSE.bit.WDT;
+#endif
+  if (!logValid()) {
+    memset(&stallLog, 0, sizeof(stallLog));
+    stallLog.magic = STALL_LOG_MAGIC;
+  }
+  stallLog.boots++;
+  if (resetByWatchdog) stallLog.watchdogResets++;
+  phase = PHASE_SETUP;
+#if defined(__SAMD51__) && WDT_PERIOD_MS > 0
+  uint8_t per = wdtCode(WDT_PERIOD_MS);
+  WDT->CTRLA.reg = 0;
+  while (WDT->SYNCBUSY.reg) {}
+  WDT->CONFIG.reg = WDT_CONFIG_PER(per);
+  // Early warning half-way through the period
+  WDT->EWCTRL.reg = WDT_EWCTRL_EWOFFSET(per ? per - 1 : 0);
+  WDT->INTFLAG.reg = WDT_INTFLAG_EW;
+  WDT->INTENSET.reg = WDT_INTENSET_EW;
+  NVIC_SetPriority(WDT_IRQn, 0);
+  NVIC_EnableIRQ(WDT_IRQn);
+  WDT->CTRLA.reg = WDT_CTRLA_ENABLE;
+  while (WDT->SYNCBUSY.reg) {}
+#endif
+}
+
+StallPhase StallMonitor::enter(StallPhase p) {
+  StallPhase prev = phase;
+  if (inPass) {
+    uint32_t now = millis();
+    spent[prev] += now - phaseSince;
+    phaseSince = now;
+  }
+  phase = p;
+  return prev;
+}
+
+void StallMonitor::beginPass(uint32_t now) {
+  memset(spent, 0, sizeof(spent));
+  passStart = now;
+  phaseSince = now;
+  phase = PHASE_LOOP;
+  inPass = true;
+}
+
+void StallMonitor::endPass(uint32_t now) {
+  spent[phase] += now - phaseSince;
+  inPass = false;
+  uint32_t ms = now - passStart;
+  StallPhase top = PHASE_LOOP;
+  for (uint8_t i = 1; i < PHASE_COUNT; ++i) if (spent[i] > spent[top]) top = (StallPhase)i;
+  if (ms > worstMs) {
+    worstMs = ms;
+    worstPhase = top;
+  }
+  if (ms >= STALL_LOG_MS) log(passStart, ms, top, false);
+  alive(0, now);
+  feed(now);
+}
+
+void StallMonitor::alive(uint8_t task, uint32_t now) {
+  if (task < MAX_TASKS) lastAlive[task] = now;
+}
+
+void StallMonitor::feed(uint32_t now) {
+  // Clearing takes a few WDT clocks to sync, so don't do it on every pass
+  if (now - lastFeedMs < 100) return;
+  for (uint8_t i = 0; i < tasks && i < MAX_TASKS; ++i) {
+    if (now - lastAlive[i] > WDT_PERIOD_MS / 2) return; // someone is stuck: let it bite
+  }
+#if defined(__SAMD51__) && WDT_PERIOD_MS > 0
+  if (WDT->SYNCBUSY.bit.CLEAR) return;
+  WDT->CLEAR.reg = WDT_CLEAR_CLEAR_KEY;
+#endif
+  lastFeedMs = now;
+}
+
+void StallMonitor::onWatchdogWarning() {
+  uint32_t start = inPass ? passStart : lastFeedMs;
+  log(start, millis() - start, phase, true);
+}
+
+void StallMonitor::log(uint32_t start, uint32_t ms, StallPhase p, bool watchdog) {
+  StallEntry &e = stallLog.entries[stallLog.next];
+  e.uptimeMs = start;
+  e.durationMs = ms > 0xFFFF ? 0xFFFF : (uint16_t)ms;
+  e.phase = p;
+  e.boot = stallLog.boots & 0x7F;
+  e.watchdog = watchdog;
+  stallLog.next = (uint8_t)((stallLog.next + 1) % STALL_LOG_LEN);
+  if (stallLog.count < STALL_LOG_LEN) stallLog.count++;
+}
+
+void StallMonitor::clear() {
+  uint16_t boots = stallLog.boots;
+  memset(&stallLog, 0, sizeof(stallLog));
+  stallLog.magic = STALL_LOG_MAGIC;
+  stallLog.boots = boots;
+  worstMs = 0;
+  worstPhase = PHASE_LOOP;
+}
+
+void StallMonitor::dump(Print &out) const {
+  char line[96];
+  snprintf(line, sizeof(line), "# stalls: boot %u, %u watchdog resets%s, worst pass this boot %lu ms (%s)",
+           (unsigned)stallLog.boots, (unsigned)stallLog.watchdogResets,
+           resetByWatchdog ? " (this boot was one)" : "", (unsigned long)worstMs, STALL_PHASE_NAMES[worstPhase]);
+  out.println(line);
+  // Oldest first
+  for (uint8_t i = 0; i < stallLog.count; ++i) {
+    uint8_t at = (uint8_t)((stallLog.next + STALL_LOG_LEN - stallLog.count + i) % STALL_LOG_LEN);
+    const StallEntry &e = stallLog.entries[at];
+    snprintf(line, sizeof(line), "# stall boot %u at %lu ms: %u ms in %s%s", (unsigned)e.boot,
+             (unsigned long)e.uptimeMs, (unsigned)e.durationMs,
+             e.phase < PHASE_COUNT ? STALL_PHASE_NAMES[e.phase] : "?", e.watchdog ? " (watchdog)" : "");
+    out.println(line);
+  }
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <stdint.h>
+#include "config.h"
+
+class Print;
+
+// What the monitored loop is doing. Names (for the dump) are in STALL_PHASE_NAMES.
+enum StallPhase : uint8_t {
+  PHASE_LOOP,     // loop bookkeeping: buttons, pages, timers
+  PHASE_SETUP,    // setup() and the steps of the BLE bring-up
+  PHASE_PARSE,    // draining Serial/BLE input through the parsers
+  PHASE_DRAW,     // any panel drawing
+  PHASE_NOTIFY,   // BLE notify RPC
+  PHASE_WAKE,     // backlight/power switching on sleep and wake
+  PHASE_FLASH,    // trace file I/O on the SPI flash
+  PHASE_COUNT
+};
+
+extern const char *const STALL_PHASE_NAMES[PHASE_COUNT];
+
+// One long loop pass, or the pass the watchdog gave up on
+struct StallEntry {
+  uint32_t uptimeMs;   // when the pass started
+  uint16_t durationMs; // saturated at 65535
+  uint8_t phase;       // StallPhase that took most of the pass
+  uint8_t boot : 7;    // low bits of the boot count it happened in
+  uint8_t watchdog : 1;
+};
+
+// Loop-latency tracker, watchdog and persistent stall log.
+//
+// Each pass of the monitored loop is bracketed by beginPass()/endPass(), and
+// STALL_SCOPE marks what it is doing, so a pass that runs past STALL_LOG_MS is
+// logged with the phase that took most of it. The log is a small ring kept in
+// the SAMD51 backup RAM, which survives resets other than power-on, so after a
+// freeze the entries from before the reboot can still be read with "?stalls".
+//
+// The hardware watchdog (WDT_PERIOD_MS) is fed at the end of healthy passes
+// while every registered task has checked in with alive() recently. Half-way
+// through the period its early-warning interrupt logs the stuck pass, phase
+// included, before the reset.
+//
+// On other targets the log lives in plain RAM and there is no watchdog.
+class StallMonitor {
+public:
+  // Load the log, count the boot, arm the watchdog; call first thing in setup()
+  void begin();
+  void beginPass(uint32_t now);
+  void endPass(uint32_t now);
+  // Mark the current phase; returns the previous one (see StallScope)
+  StallPhase enter(StallPhase p);
+  // Tasks the watchdog waits on (RTOS mode); task 0 is the monitored loop
+  void alive(uint8_t task, uint32_t now);
+  void expectTasks(uint8_t n) { tasks = n; }
+
+  void dump(Print &out) const;
+  void clear();
+
+  // Called from the watchdog early-warning interrupt
+  void onWatchdogWarning();
+
+  uint32_t worstMs = 0;          // longest pass this boot
+  StallPhase worstPhase = PHASE_LOOP;
+  bool resetByWatchdog = false;  // this boot followed a watchdog reset
+
+  static const uint8_t MAX_TASKS = 3;
+
+private:
+  void feed(uint32_t now);
+  void log(uint32_t start, uint32_t ms, StallPhase phase, bool watchdog);
+
+  volatile StallPhase phase = PHASE_SETUP;
+  uint32_t phaseSince = 0;
+  uint32_t passStart = 0;
+  bool inPass = false;
+  uint32_t spent[PHASE_COUNT] = {};
+  uint32_t lastAlive[MAX_TASKS] = {};
+  uint8_t tasks = 1;
+  uint32_t lastFeedMs = 0;
+};
+
+extern StallMonitor stallMonitor;
+
+// Attributes the enclosing scope to one phase, then restores the previous one
+class StallScope {
+public:
+  explicit StallScope(StallPhase p) : prev(stallMonitor.enter(p)) {}
+  ~StallScope() { stallMonitor.enter(prev); }
+
+private:
+  StallPhase prev;
+};
+
+#if WIO_STALL_MONITOR
+#define STALL_SCOPE(p) StallScope stallScope_(p)
+#else
+#define STALL_SCOPE(p) do {} while (0)
+#endif
@@ -0,0 +1,156 @@
+#include "trace.h"
+#include <string.h>
+#include "flash_fs.h"
+
+TraceStore traceStore;
+
+#if WIO_TRACE && defined(__SAMD51__)
+#include <Arduino.h>
+#include <Seeed_FS.h>
+#include "SFUD/Seeed_SFUD.h"
+
+static File traceFile;
+static const uint8_t TRACE_MAGIC[4] = { 'W', 'T', 'R', '1' };
+
+bool TraceStore::begin() {
+  mounted = flashFsMount();
+  return mounted;
+}
+
+bool TraceStore::startRecording(uint32_t now) {
+  if (!mounted || isRecording || isReplaying) return false;
+  FlashLock lock;
+  SPIFLASH.remove(TRACE_PATH);
+  traceFile = SPIFLASH.open(TRACE_PATH, FILE_WRITE);
+  if (!traceFile) return false;
+  traceFile.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  records = bytes = dropped = 0;
+  bufLen = 0;
+  startMs = now;
+  recordingEnded = false;
+  isRecording = true;
+  return true;
+}
+
+void TraceStore::record(Source src, const uint8_t *data, size_t len, uint32_t now) {
+  if (!isRecording) return;
+  if (len > MAX_RECORD) len = MAX_RECORD;
+  if (bytes + RECORD_HEADER + len > TRACE_MAX_BYTES) {
+    // Full: keep what fits and end the recording here
+    stopRecording();
+    recordingEnded = true;
+    return;
+  }
+  if (bufLen + RECORD_HEADER + len > sizeof(buf)) service();
+  if (bufLen + RECORD_HEADER + len > sizeof(buf)) {
+    dropped++;
+    return;
+  }
+  uint32_t t = now - startMs;
+  uint8_t *h = buf + bufLen;
+  h[0] = (uint8_t)t; h[1] = (uint8_t)(t >> 8); h[2] = (uint8_t)(t >> 16); h[3] = (uint8_t)(t >> 24);
+  h[4] = src;
+  h[5] = (uint8_t)len; h[6] = (uint8_t)(len >> 8);
+  memcpy(h + RECORD_HEADER, data, len);
+  bufLen += RECORD_HEADER + len;
+  bytes += RECORD_HEADER + len;
+  records++;
+}
+
+void TraceStore::service() {
+  if (!isRecording || bufLen == 0) return;
+  FlashLock lock;
+  traceFile.write(buf, bufLen);
+  bufLen = 0;
+}
+
+void TraceStore::stopRecording() {
+  if (!isRecording) return;
+  service();
+  FlashLock lock;
+  traceFile.close();
+  isRecording = false;
+}
+
+bool TraceStore::startReplay(Pace p, uint16_t hz, uint32_t now) {
+  if (!mounted || isRecording || isReplaying) return false;
+  FlashLock lock;
+  traceFile = SPIFLASH.open(TRACE_PATH, FILE_READ);
+  if (!traceFile) return false;
+  uint8_t magic[4];
+  if (traceFile.read(magic, sizeof(magic)) != (int)sizeof(magic) || memcmp(magic, TRACE_MAGIC, 4) != 0) {
+    traceFile.close();
+    return false;
+  }
+  pace = p;
+  intervalMs = (p == PACE_FIXED && hz) ? 1000u / hz : 0;
+  records = bytes = dropped = 0;
+  startMs = lastPlayMs = now;
+  havePending = false;
+  replayEnded = false;
+  isReplaying = true;
+  return true;
+}
+
+// Load the next record into the look-ahead slot
+bool TraceStore::readNext() {
+  uint8_t h[RECORD_HEADER];
+  FlashLock lock;
+  if (traceFile.read(h, sizeof(h)) != (int)sizeof(h)) return false;
+  pendingT = (uint32_t)h[0] | ((uint32_t)h[1] << 8) | ((uint32_t)h[2] << 16) | ((uint32_t)h[3] << 24);
+  pendingSrc = (Source)h[4];
+  pendingLen = (uint16_t)(h[5] | (h[6] << 8));
+  if (pendingLen > MAX_RECORD) return false;
+  if (traceFile.read(pending, pendingLen) != (int)pendingLen) return false;
+  havePending = true;
+  return true;
+}
+
+size_t TraceStore::nextDue(uint32_t now, Source &src, uint8_t *out, size_t cap) {
+  if (!isReplaying) return 0;
+  if (!havePending && !readNext()) {
+    stopReplay();
+    replayEnded = true;
+    return 0;
+  }
+  if (pendingLen > cap) {
+    havePending = false;
+    dropped++;
+    return 0;
+  }
+  bool due;
+  switch (pace) {
+    case PACE_REALTIME: due = now - startMs >= pendingT; break;
+    case PACE_FIXED:    due = now - lastPlayMs >= intervalMs; break;
+    default:            due = true; break;
+  }
+  if (!due) return 0;
+  memcpy(out, pending, pendingLen);
+  src = pendingSrc;
+  havePending = false;
+  lastPlayMs = now;
+  records++;
+  bytes += pendingLen;
+  return pendingLen;
+}
+
+void TraceStore::stopReplay() {
+  if (!isReplaying) return;
+  FlashLock lock;
+  traceFile.close();
+  isReplaying = false;
+}
+
+#else
+
+bool TraceStore::begin() { return false; }
+bool TraceStore::startRecording(uint32_t) { return false; }
+void TraceStore::record(Source, const uint8_t *, size_t, uint32_t) {}
+void TraceStore::service() {}
+void TraceStore::stopRecording() {}
+bool TraceStore::startReplay(Pace, uint16_t, uint32_t) { return false; }
+bool TraceStore::readNext() { return false; }
+size_t TraceStore::nextDue(uint32_t, Source &, uint8_t *, size_t) { return 0; }
+void TraceStore::stopReplay() {}
+
+#endif
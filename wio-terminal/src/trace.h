@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// Raw input capture to the SPI flash, and paced replay through the live ingest
+// path, for repeatable load tests without a PC and for reproducing field stalls.
+//
+// File layout (TRACE_PATH): "WTR1", then one record per BLE packet or serial
+// burst: [ms since start, uint32 LE][source][length, uint16 LE][bytes].
+//
+// Everything here runs in the ingest context (loop(), or the ingest task), and
+// only the flash itself is shared, with the skin (see FlashLock). Recording
+// buffers in RAM and writes whole chunks, so a stall in the flash shows up as
+// PERF_PARSE time, not as lost input.
+class TraceStore {
+public:
+  enum Source : uint8_t { TRACE_SERIAL = 0, TRACE_BLE = 1 };
+  enum Pace : uint8_t {
+    PACE_REALTIME,  // original timing (1x)
+    PACE_MAX,       // as fast as the pipeline takes it
+    PACE_FIXED,     // one record every 1000/hz ms
+  };
+
+  // Mount the flash file system; trace commands fail while this is false
+  bool begin();
+  bool available() const { return mounted; }
+
+  bool startRecording(uint32_t now);
+  bool recording() const { return isRecording; }
+  // Append one record (no-op unless recording). A record that would take the
+  // file past TRACE_MAX_BYTES ends the recording instead.
+  void record(Source src, const uint8_t *data, size_t len, uint32_t now);
+  void stopRecording();
+  // True once after record() ended a recording at the size cap
+  bool takeRecordingEnded() { bool e = recordingEnded; recordingEnded = false; return e; }
+
+  bool startReplay(Pace pace, uint16_t hz, uint32_t now);
+  bool replaying() const { return isReplaying; }
+  // Copy out the next record if it is due at `now`; returns its length, 0 if none
+  size_t nextDue(uint32_t now, Source &src, uint8_t *out, size_t cap);
+  void stopReplay();
+  // True once after a replay reached the end of the file
+  bool takeReplayEnded() { bool e = replayEnded; replayEnded = false; return e; }
+
+  // Flush buffered records to flash (call regularly while recording)
+  void service();
+
+  uint32_t records = 0;        // written (recording) or played (replay)
+  uint32_t bytes = 0;
+  uint32_t dropped = 0;        // records not written because the RAM buffer was full
+  uint32_t startMs = 0;
+
+  static const size_t RECORD_HEADER = 7;
+  static const size_t MAX_RECORD = 512;
+
+private:
+  bool readNext();
+
+  bool mounted = false;
+  bool isRecording = false;
+  bool isReplaying = false;
+  bool replayEnded = false;
+  bool recordingEnded = false;
+  Pace pace = PACE_REALTIME;
+  uint32_t intervalMs = 0;
+  uint32_t lastPlayMs = 0;
+
+  uint8_t buf[WIO_TRACE ? TRACE_BUFFER : 1];   // pending writes while recording
+  size_t bufLen = 0;
+
+  // Look-ahead record during replay
+  bool havePending = false;
+  uint32_t pendingT = 0;
+  Source pendingSrc = TRACE_SERIAL;
+  uint16_t pendingLen = 0;
+  uint8_t pending[WIO_TRACE ? MAX_RECORD : 1];
+};
+
+extern TraceStore traceStore;